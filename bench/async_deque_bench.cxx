@@ -0,0 +1,117 @@
+// Measures the cost of one hand-off ("hop") between two parties that
+// ping-pong a counter through a pair of queues:
+//
+//   coroutine   two coroutines on a single-threaded event loop, using
+//               AsyncDeque (a hop is a suspend plus a resume)
+//   condvar     two threads, using BlockingDeque (a hop is a condition
+//               variable wakeup and a thread context switch)
+
+#include "AsyncDeque.hxx"
+#include "BlockingDeque.hxx"
+
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <thread>
+
+using namespace ipd;
+
+namespace {
+    struct EventLoop {
+        std::deque<std::coroutine_handle<>> ready;
+
+        void run()
+        {
+            while (!ready.empty()) {
+                std::coroutine_handle<> h = ready.front();
+                ready.pop_front();
+                h.resume();
+            }
+        }
+    };
+
+    struct LoopExecutor {
+        EventLoop *loop;
+
+        void execute(std::coroutine_handle<> h) const
+        {
+            loop->ready.push_back(h);
+        }
+    };
+
+    struct task {
+        struct promise_type {
+            task get_return_object() { return {}; }
+            std::suspend_never initial_suspend() { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    using queue = AsyncDeque<long, LoopExecutor>;
+
+    task player(queue &in, queue &out, long hops)
+    {
+        for (;;) {
+            long n = co_await in.pop_front();
+            if (n >= hops) {
+                out.push_back(n);
+                co_return;
+            }
+            out.push_back(n + 1);
+        }
+    }
+
+    double coroutine_hop_ns(long hops)
+    {
+        EventLoop loop;
+        queue ping(LoopExecutor{&loop}), pong(LoopExecutor{&loop});
+        player(ping, pong, hops);
+        player(pong, ping, hops);
+
+        auto start = std::chrono::steady_clock::now();
+        ping.push_back(0);
+        loop.run();
+        std::chrono::duration<double, std::nano> elapsed =
+                std::chrono::steady_clock::now() - start;
+        return elapsed.count() / double(hops);
+    }
+
+    double condvar_hop_ns(long hops)
+    {
+        BlockingDeque<long> ping(1), pong(1);
+        auto play = [hops](BlockingDeque<long> &in, BlockingDeque<long> &out) {
+            long n;
+            while (in.pop_front(n)) {
+                if (n >= hops) {
+                    out.push_back(n);
+                    return;
+                }
+                out.push_back(n + 1);
+            }
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        std::thread a(play, std::ref(ping), std::ref(pong));
+        std::thread b(play, std::ref(pong), std::ref(ping));
+        ping.push_back(0);
+        a.join();
+        b.join();
+        std::chrono::duration<double, std::nano> elapsed =
+                std::chrono::steady_clock::now() - start;
+        return elapsed.count() / double(hops);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    long hops = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 1000000;
+    std::printf("%-10s %12s\n", "mode", "ns/hop");
+    std::printf("%-10s %12.1f\n", "coroutine", coroutine_hop_ns(hops));
+    std::printf("%-10s %12.1f\n", "condvar", condvar_hop_ns(hops / 10));
+}
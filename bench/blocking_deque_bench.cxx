@@ -0,0 +1,65 @@
+// Measures BlockingDeque throughput between one producer and one consumer
+// as a function of batch size. Batch size 1 uses the single-element
+// operations; larger batches use the bulk operations.
+
+#include "BlockingDeque.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    double run(size_t batch, size_t items)
+    {
+        BlockingDeque<long> dq(1024);
+        auto start = std::chrono::steady_clock::now();
+
+        std::thread producer([&] {
+            if (batch == 1) {
+                for (size_t i = 0; i < items; ++i)
+                    dq.push_back(long(i));
+            } else {
+                std::vector<long> buf(batch);
+                for (size_t i = 0; i < items; i += batch) {
+                    size_t n = std::min(batch, items - i);
+                    for (size_t j = 0; j < n; ++j)
+                        buf[j] = long(i + j);
+                    dq.push_back_bulk(buf.begin(), buf.begin() + n);
+                }
+            }
+            dq.close();
+        });
+
+        long sum = 0;
+        if (batch == 1) {
+            long x;
+            while (dq.pop_front(x))
+                sum += x;
+        } else {
+            std::vector<long> buf(batch);
+            size_t n;
+            while ((n = dq.pop_front_bulk(buf.begin(), batch)) != 0)
+                for (size_t j = 0; j < n; ++j)
+                    sum += buf[j];
+        }
+        producer.join();
+
+        std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+        if (sum != long(items * (items - 1) / 2))
+            std::fprintf(stderr, "checksum mismatch\n");
+        return double(items) / elapsed.count();
+    }
+}
+
+int main()
+{
+    const size_t items = 2000000;
+    std::printf("%8s %16s\n", "batch", "items/sec");
+    for (size_t batch : {1, 4, 16, 64, 256})
+        std::printf("%8zu %16.0f\n", batch, run(batch, items));
+}
@@ -0,0 +1,106 @@
+// Measures the heap footprint per element of Deque<int> and XorDeque<int>
+// (with std::deque<int> for reference) by replacing the global operator
+// new and delete. "requested" counts the bytes asked for; "usable" counts
+// what malloc actually handed out, which includes rounding, and adds one
+// allocation header per block.
+
+#include "Deque.hxx"
+#include "XorDeque.hxx"
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <malloc.h>
+#include <new>
+
+using namespace ipd;
+
+namespace {
+    struct counters {
+        long blocks;
+        long requested;
+        long usable;
+    };
+
+    counters live{0, 0, 0};
+
+    // glibc keeps one size word in front of every chunk.
+    constexpr long malloc_header = sizeof(size_t);
+
+    template<typename Q>
+    void report(const char *name, long n)
+    {
+        counters before = live;
+        {
+            Q q;
+            for (long i = 0; i < n; ++i) {
+                if (i % 2)
+                    q.push_back(int(i));
+                else
+                    q.push_front(int(i));
+            }
+            long blocks = live.blocks - before.blocks;
+            long requested = live.requested - before.requested;
+            long usable = live.usable - before.usable + blocks * malloc_header;
+            std::printf("%-16s %10ld %10ld %12.2f %12.2f\n", name, n, blocks,
+                        double(requested) / double(n), double(usable) / double(n));
+        }
+    }
+}
+
+void *operator new(size_t size)
+{
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    live.blocks++;
+    live.requested += long(size);
+    live.usable += long(malloc_usable_size(p));
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p == nullptr)
+        return;
+    live.blocks--;
+    live.usable -= long(malloc_usable_size(p));
+    // Through a pointer, so that GCC does not pair this free with the
+    // operator new it sees inlined at the call site and warn.
+    void (*volatile release)(void *) = std::free;
+    release(p);
+}
+
+void operator delete(void *p, size_t size) noexcept
+{
+    if (p == nullptr)
+        return;
+    live.requested -= long(size);
+    operator delete(p);
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void *p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void *p, size_t size) noexcept
+{
+    operator delete(p, size);
+}
+
+int main()
+{
+    std::printf("%-16s %10s %10s %12s %12s\n",
+                "container", "elements", "blocks", "req B/elem", "heap B/elem");
+    for (long n : {100L, 10000L, 1000000L}) {
+        report<Deque<int>>("Deque<int>", n);
+        report<XorDeque<int>>("XorDeque<int>", n);
+        report<std::deque<int>>("std::deque<int>", n);
+    }
+}
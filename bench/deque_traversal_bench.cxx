@@ -0,0 +1,145 @@
+// Measures how fast a Deque can be walked once its nodes are scattered
+// through the heap, for several element sizes. Elements are pushed onto 64
+// deques in random order, so consecutive nodes of one deque are far apart,
+// and each deque is then summed through its iterators. Time, last-level
+// cache misses and L1 data-cache read misses are reported per element;
+// the counters come from perf_event_open and show "n/a" where the kernel
+// does not allow them (e.g. in containers, or with perf_event_paranoid > 2).
+//
+// The deque_traversal_bench_noprefetch target builds the same file with
+// IPD_DEQUE_PREFETCH=0 for comparison.
+
+#include "Deque.hxx"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <memory>
+#include <random>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    template<size_t Bytes>
+    struct payload {
+        uint64_t words[Bytes / sizeof(uint64_t)];
+
+        explicit payload(uint64_t x) {
+            for (uint64_t &w : words)
+                w = x;
+        }
+    };
+
+    // One hardware counter, or none if the kernel refuses to open it.
+    class counter {
+    public:
+        counter(uint32_t type, uint64_t config) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof attr);
+            attr.size = sizeof attr;
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd_ = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        counter(const counter &) = delete;
+
+        counter &operator=(const counter &) = delete;
+
+        ~counter() {
+            if (fd_ >= 0)
+                close(fd_);
+        }
+
+        void start() {
+            if (fd_ < 0)
+                return;
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+
+        // Returns the count since `start`, or -1 if unavailable.
+        long long stop() {
+            if (fd_ < 0)
+                return -1;
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            long long value;
+            if (read(fd_, &value, sizeof value) != long(sizeof value))
+                return -1;
+            return value;
+        }
+
+    private:
+        int fd_;
+    };
+
+    void print_per(long long count, double n)
+    {
+        if (count < 0)
+            std::printf(" %12s", "n/a");
+        else
+            std::printf(" %12.3f", double(count) / n);
+    }
+
+    template<size_t Bytes>
+    void run(size_t heap_bytes)
+    {
+        using T = payload<Bytes>;
+        const size_t lists = 64;
+        const size_t n = heap_bytes / (Bytes + 2 * sizeof(void *));
+
+        std::vector<Deque<T>> deques(lists);
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<size_t> pick(0, lists - 1);
+        for (size_t i = 0; i < n; ++i)
+            deques[pick(rng)].push_back(T(i));
+
+        counter llc(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        counter l1d(PERF_TYPE_HW_CACHE,
+                    PERF_COUNT_HW_CACHE_L1D |
+                    (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+
+        uint64_t sum = 0;
+        llc.start();
+        l1d.start();
+        auto start = std::chrono::steady_clock::now();
+        for (const Deque<T> &dq : deques) {
+            for (const T &x : dq)
+                sum += x.words[0];
+        }
+        std::chrono::duration<double, std::nano> elapsed =
+                std::chrono::steady_clock::now() - start;
+        long long l1d_misses = l1d.stop();
+        long long llc_misses = llc.stop();
+
+        if (sum != uint64_t(n) * (n - 1) / 2)
+            std::fprintf(stderr, "checksum mismatch\n");
+
+        std::printf("%8zu %10zu %10.2f", Bytes, n, elapsed.count() / double(n));
+        print_per(llc_misses, double(n));
+        print_per(l1d_misses, double(n));
+        std::printf("\n");
+    }
+}
+
+int main()
+{
+    const size_t heap_bytes = size_t(256) << 20;
+
+    std::printf("prefetch %s\n", IPD_DEQUE_PREFETCH ? "on" : "off");
+    std::printf("%8s %10s %10s %12s %12s\n",
+                "T bytes", "elements", "ns/elem", "LLC miss/el", "L1D miss/el");
+    run<8>(heap_bytes);
+    run<64>(heap_bytes);
+    run<256>(heap_bytes);
+}
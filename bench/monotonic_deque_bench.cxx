@@ -0,0 +1,96 @@
+// Sliding-window minimum over a random-walk metric stream: a naive window
+// that rescans all w values on every step, against MonotonicDeque fed one
+// value at a time and in batches of 64 (querying once per batch). Reports
+// ns per input value for several window widths.
+
+#include "Deque.hxx"
+#include "MonotonicDeque.hxx"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    // Keeps the checksums, and so the work, from being optimized away.
+    volatile long sink;
+
+    double ns_per(clock_type::time_point start, size_t n)
+    {
+        std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+        return elapsed.count() / double(n);
+    }
+
+    double naive(const std::vector<long> &values, size_t n, size_t w, long &checksum)
+    {
+        Deque<long> window;
+        auto start = clock_type::now();
+        for (size_t i = 0; i < n; ++i) {
+            window.push_back(values[i]);
+            if (window.size() > w)
+                window.pop_front();
+            long best = window.front();
+            for (long v : window)
+                best = v < best ? v : best;
+            checksum += best;
+        }
+        return ns_per(start, n);
+    }
+
+    double monotonic(const std::vector<long> &values, size_t n, size_t w, long &checksum)
+    {
+        MonotonicDeque<long> window;
+        auto start = clock_type::now();
+        for (size_t i = 0; i < n; ++i) {
+            window.push(values[i]);
+            if (i + 1 >= w)
+                window.expire(i + 1 - w);
+            checksum += window.top();
+        }
+        return ns_per(start, n);
+    }
+
+    double batched(const std::vector<long> &values, size_t n, size_t w, long &checksum)
+    {
+        const size_t batch = 64;
+        MonotonicDeque<long> window;
+        auto start = clock_type::now();
+        for (size_t i = 0; i < n; i += batch) {
+            size_t end = i + batch < n ? i + batch : n;
+            window.push_n(values.begin() + long(i), values.begin() + long(end));
+            if (end >= w)
+                window.expire(end - w);
+            checksum += window.top();
+        }
+        return ns_per(start, n);
+    }
+}
+
+int main()
+{
+    const size_t n = 4000000;
+    std::mt19937 rng(1);
+    std::normal_distribution<double> step(0, 10);
+    std::vector<long> values(n);
+    double level = 0;
+    for (long &v : values) {
+        level += step(rng);
+        v = long(level);
+    }
+
+    std::printf("%8s %12s %12s %12s\n", "window", "naive", "monotonic", "push_n(64)");
+    for (size_t w : {16, 256, 4096}) {
+        // Keep the quadratic baseline to a few seconds.
+        size_t naive_n = n < size_t(400000000) / w ? n : size_t(400000000) / w;
+        long a = 0, b = 0, c = 0;
+        double naive_ns = naive(values, naive_n, w, a);
+        double mono_ns = monotonic(values, n, w, b);
+        double batch_ns = batched(values, n, w, c);
+        std::printf("%8zu %12.2f %12.2f %12.2f\n", w, naive_ns, mono_ns, batch_ns);
+        sink = a + b + c;
+    }
+}
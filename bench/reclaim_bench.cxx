@@ -0,0 +1,105 @@
+// Compares the EpochReclaim and HazardReclaim policies of ConcurrentDeque:
+// throughput of push/pop pairs across threads, and the peak resident set
+// size of the process. Each run happens in a forked child so that peak RSS
+// (from wait4) belongs to that run alone. The "stalled" runs keep one extra
+// thread parked inside an operation's guard for the whole run, which is
+// what a descheduled thread looks like to the reclaimer.
+
+#include "ConcurrentDeque.hxx"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    struct payload {
+        long words[8];
+    };
+
+    template<typename Reclaim>
+    void workload(size_t threads, size_t ops, bool stalled)
+    {
+        ConcurrentDeque<payload, Reclaim> dq;
+        std::atomic<bool> done(false);
+        std::atomic<bool> parked(false);
+
+        std::thread staller;
+        if (stalled) {
+            staller = std::thread([&] {
+                typename Reclaim::guard guard;
+                parked.store(true);
+                while (!done.load())
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            });
+            while (!parked.load())
+                std::this_thread::yield();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                payload p{};
+                for (size_t i = 0; i < ops; ++i) {
+                    dq.push_back(p);
+                    dq.try_pop_front(p);
+                }
+            });
+        }
+        for (auto &w : workers)
+            w.join();
+        std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+
+        done.store(true);
+        if (stalled)
+            staller.join();
+
+        std::printf("%12.0f", double(2 * threads * ops) / elapsed.count());
+        std::fflush(stdout);
+    }
+
+    template<typename Reclaim>
+    void run(const char *name, size_t threads, size_t ops, bool stalled)
+    {
+        std::printf("%-8s %-8s %8zu ", name, stalled ? "yes" : "no", threads);
+        std::fflush(stdout);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            workload<Reclaim>(threads, ops, stalled);
+            std::_Exit(0);
+        }
+
+        int status;
+        struct rusage usage;
+        wait4(pid, &status, 0, &usage);
+        std::printf(" %14ld\n", usage.ru_maxrss);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t ops = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    size_t max_threads = std::thread::hardware_concurrency();
+    if (max_threads == 0)
+        max_threads = 4;
+
+    std::printf("%-8s %-8s %8s %12s %14s\n",
+                "policy", "stalled", "threads", "ops/sec", "peak RSS (KiB)");
+    for (bool stalled : {false, true}) {
+        for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+            run<EpochReclaim>("epoch", threads, ops, stalled);
+            run<HazardReclaim>("hazard", threads, ops, stalled);
+        }
+    }
+}
@@ -0,0 +1,142 @@
+// Slicing workload from log merging: repeatedly cut a sequence at a random
+// position and glue the halves back in swapped order, then read random
+// positions. The linked Deque has O(n) splice and no split, so it cuts by
+// popping into a second deque and indexes by walking an iterator; RopeDeque
+// does both in O(log n). Reports ns per cut-and-glue and per index for
+// several sequence lengths, then ns per push/pop pair at the front when
+// the front buffer sits just below a flush, which must stay O(1).
+
+#include "Deque.hxx"
+#include "RopeDeque.hxx"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    // Keeps the checksums, and so the work, from being optimized away.
+    volatile long sink;
+
+    double ns_per(clock_type::time_point start, size_t n)
+    {
+        std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+        return elapsed.count() / double(n);
+    }
+
+    double linked_slice(const std::vector<size_t> &cuts, size_t n, size_t ops)
+    {
+        Deque<long> dq;
+        for (size_t i = 0; i < n; ++i)
+            dq.push_back(long(i));
+        auto start = clock_type::now();
+        for (size_t k = 0; k < ops; ++k) {
+            Deque<long> head;
+            for (size_t i = 0; i < cuts[k]; ++i) {
+                head.push_back(dq.front());
+                dq.pop_front();
+            }
+            dq.splice(head);
+        }
+        double result = ns_per(start, ops);
+        sink = dq.front();
+        return result;
+    }
+
+    double rope_slice(const std::vector<size_t> &cuts, size_t n, size_t ops)
+    {
+        RopeDeque<long> dq;
+        for (size_t i = 0; i < n; ++i)
+            dq.push_back(long(i));
+        auto start = clock_type::now();
+        for (size_t k = 0; k < ops; ++k) {
+            RopeDeque<long> tail = dq.split_at(cuts[k]);
+            tail.concat(dq);
+            dq = std::move(tail);
+        }
+        double result = ns_per(start, ops);
+        sink = dq.front();
+        return result;
+    }
+
+    double linked_index(const std::vector<size_t> &cuts, size_t n, size_t ops)
+    {
+        Deque<long> dq;
+        for (size_t i = 0; i < n; ++i)
+            dq.push_back(long(i));
+        long checksum = 0;
+        auto start = clock_type::now();
+        for (size_t k = 0; k < ops; ++k) {
+            auto it = dq.begin();
+            for (size_t i = 0; i < cuts[k] && i + 1 < n; ++i)
+                ++it;
+            checksum += *it;
+        }
+        double result = ns_per(start, ops);
+        sink = checksum;
+        return result;
+    }
+
+    double rope_index(const std::vector<size_t> &cuts, size_t n, size_t ops)
+    {
+        RopeDeque<long> dq;
+        for (size_t i = 0; i < n; ++i)
+            dq.push_back(long(i));
+        long checksum = 0;
+        auto start = clock_type::now();
+        for (size_t k = 0; k < ops; ++k)
+            checksum += dq[cuts[k] < n ? cuts[k] : n - 1];
+        double result = ns_per(start, ops);
+        sink = checksum;
+        return result;
+    }
+
+    double rope_boundary(size_t n, size_t ops)
+    {
+        RopeDeque<long> dq;
+        for (size_t i = 0; i < n; ++i)
+            dq.push_back(long(i));
+        // One push short of a full front buffer.
+        for (int i = 0; i < 63; ++i)
+            dq.push_front(-1);
+        auto start = clock_type::now();
+        for (size_t k = 0; k < ops; ++k) {
+            dq.push_front(long(k));
+            dq.pop_front();
+        }
+        double result = ns_per(start, ops);
+        sink = dq.front();
+        return result;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+
+    std::printf("%10s %14s %14s %14s %14s\n", "n",
+                "linked slice", "rope slice", "linked index", "rope index");
+    for (size_t n : {1000, 100000, 1000000}) {
+        // Keep the linear baselines to a few seconds.
+        size_t linked_ops = size_t(20000000) / n;
+        size_t rope_ops = 200000;
+        std::vector<size_t> cuts(rope_ops);
+        for (size_t &c : cuts)
+            c = rng() % (n + 1);
+        if (linked_ops > rope_ops)
+            linked_ops = rope_ops;
+
+        double ls = linked_slice(cuts, n, linked_ops);
+        double rs = rope_slice(cuts, n, rope_ops);
+        double li = linked_index(cuts, n, linked_ops);
+        double ri = rope_index(cuts, n, rope_ops);
+        std::printf("%10zu %14.1f %14.1f %14.1f %14.1f\n", n, ls, rs, li, ri);
+    }
+
+    std::printf("\nrope push/pop pair at the front buffer boundary: %.1f ns\n",
+                rope_boundary(100000, 10000000));
+}
@@ -0,0 +1,58 @@
+// Compares Deque and SmallDeque on a small-queue workload: many short-lived
+// deques whose sizes follow a geometric distribution with mean 4, so most
+// stay under the inline capacity of 8 and a few grow well past it.
+
+#include "Deque.hxx"
+#include "SmallDeque.hxx"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    template<typename Q>
+    double ns_per_element(const std::vector<int> &sizes, long &checksum)
+    {
+        long elements = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int n : sizes) {
+            Q q;
+            for (int i = 0; i < n; ++i) {
+                if (i % 3 == 0)
+                    q.push_front(i);
+                else
+                    q.push_back(i);
+            }
+            while (!q.empty()) {
+                checksum += q.front();
+                q.pop_front();
+            }
+            elements += n;
+        }
+        std::chrono::duration<double, std::nano> elapsed =
+                std::chrono::steady_clock::now() - start;
+        return elapsed.count() / double(elements);
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(42);
+    std::geometric_distribution<int> size_dist(0.2);
+    std::vector<int> sizes(2000000);
+    for (int &n : sizes)
+        n = size_dist(rng);
+
+    long a = 0, b = 0;
+    double deque_ns = ns_per_element<Deque<int>>(sizes, a);
+    double small_ns = ns_per_element<SmallDeque<int, 8>>(sizes, b);
+    if (a != b)
+        std::fprintf(stderr, "checksum mismatch\n");
+
+    std::printf("%-18s %10s\n", "container", "ns/element");
+    std::printf("%-18s %10.2f\n", "Deque<int>", deque_ns);
+    std::printf("%-18s %10.2f\n", "SmallDeque<int, 8>", small_ns);
+}
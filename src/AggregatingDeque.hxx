@@ -0,0 +1,162 @@
+#pragma once
+
+/*
+ * A FIFO window that can report the combination of everything in it under
+ * any associative operation (a monoid) in O(1), for rolling sums, GCDs,
+ * products of matrices and the like, without recomputing the window.
+ *
+ * A monoid is a type with `T identity() const` and
+ * `T operator()(const T &, const T &) const`; the operation must be
+ * associative but need not be commutative, and `query` combines the
+ * elements oldest first. `SumMonoid` is provided as the default.
+ *
+ * This is the two-stack algorithm, laid out in a single `Deque`: the
+ * oldest `front_count_` elements (the "front stack") each cache the
+ * combination of themselves and every newer front element, and the rest
+ * (the "back stack") are summarised by one running aggregate. Popping
+ * from an empty front stack turns the whole back stack into the front
+ * stack in one backward pass. Each element is combined a constant number
+ * of times, so every operation is O(1) amortized; a single `pop_front`
+ * can take O(n).
+ */
+
+#include "Deque.hxx"
+
+#include <cstddef>
+#include <utility>
+
+namespace ipd {
+
+    // Addition, with a value-initialized T as the identity.
+    template<typename T>
+    struct SumMonoid {
+        T identity() const { return T(); }
+
+        T operator()(const T &a, const T &b) const { return a + b; }
+    };
+
+    template<typename T, typename Monoid = SumMonoid<T>>
+    class AggregatingDeque {
+    public:
+        // Constructs a new, empty deque.
+        explicit AggregatingDeque(Monoid monoid = Monoid());
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns a reference to the first (oldest) element. If the deque is
+        // empty then the behavior is undefined.
+        const T &front() const;
+
+        // Returns a reference to the last (newest) element. If the deque is
+        // empty then the behavior is undefined.
+        const T &back() const;
+
+        // Returns the combination of all elements, oldest first, or the
+        // identity if the deque is empty.
+        T query() const;
+
+        // Inserts a new element at the back of the deque.
+        void push_back(const T &);
+
+        // Removes the first element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_front();
+
+        // Removes all elements from the deque.
+        void clear();
+
+    private:
+        struct entry_ {
+            T value;
+            // For front-stack entries, the combination of this value and
+            // every newer front-stack value. Unused in the back stack.
+            T agg;
+        };
+
+        // Turns the back stack into the front stack.
+        void flip_();
+
+        // Private member variables:
+        Deque<entry_> entries_;
+        size_t front_count_;
+        T back_agg_;
+        Monoid monoid_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, typename Monoid>
+    AggregatingDeque<T, Monoid>::AggregatingDeque(Monoid monoid)
+            : front_count_(0), back_agg_(monoid.identity()),
+              monoid_(std::move(monoid)) {}
+
+    template<typename T, typename Monoid>
+    bool AggregatingDeque<T, Monoid>::empty() const {
+        return entries_.empty();
+    }
+
+    template<typename T, typename Monoid>
+    size_t AggregatingDeque<T, Monoid>::size() const {
+        return entries_.size();
+    }
+
+    template<typename T, typename Monoid>
+    const T &AggregatingDeque<T, Monoid>::front() const {
+        return entries_.front().value;
+    }
+
+    template<typename T, typename Monoid>
+    const T &AggregatingDeque<T, Monoid>::back() const {
+        return entries_.back().value;
+    }
+
+    template<typename T, typename Monoid>
+    T AggregatingDeque<T, Monoid>::query() const {
+        if (front_count_ == 0)
+            return back_agg_;
+        return monoid_(entries_.front().agg, back_agg_);
+    }
+
+    template<typename T, typename Monoid>
+    void AggregatingDeque<T, Monoid>::push_back(const T &value) {
+        entries_.push_back(entry_{value, value});
+        back_agg_ = monoid_(back_agg_, value);
+    }
+
+    template<typename T, typename Monoid>
+    void AggregatingDeque<T, Monoid>::pop_front() {
+        if (empty())
+            return;
+        if (front_count_ == 0)
+            flip_();
+        entries_.pop_front();
+        front_count_--;
+    }
+
+    template<typename T, typename Monoid>
+    void AggregatingDeque<T, Monoid>::clear() {
+        entries_.clear();
+        front_count_ = 0;
+        back_agg_ = monoid_.identity();
+    }
+
+    template<typename T, typename Monoid>
+    void AggregatingDeque<T, Monoid>::flip_() {
+        // The front stack is empty, so every entry is in the back stack.
+        auto it = entries_.end();
+        T running = monoid_.identity();
+        while (it != entries_.begin()) {
+            --it;
+            running = monoid_(it->value, running);
+            it->agg = running;
+        }
+        front_count_ = entries_.size();
+        back_agg_ = monoid_.identity();
+    }
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+/*
+ * A deque for C++20 coroutines. `co_await q.pop_front()` completes at
+ * once if the deque has an element and otherwise suspends the coroutine
+ * until a producer pushes one; no thread ever waits. A push that finds
+ * suspended consumers hands its element straight to the oldest one and
+ * asks the `Executor` to resume it.
+ *
+ * An executor is any type with a member `execute(std::coroutine_handle<>)`.
+ * The default, `InlineExecutor`, resumes the consumer inside `push_back`,
+ * which is the cheapest option but runs the consumer on the producer's
+ * stack; an event loop that queues the handle avoids that.
+ *
+ * The deque may be used from several threads; the internal lock is held
+ * only for O(1) bookkeeping and never while a coroutine runs. Coroutines
+ * still suspended in `pop_front` when the deque is destroyed are never
+ * resumed.
+ */
+
+#include "Deque.hxx"
+
+#include <coroutine>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace ipd {
+
+    // Resumes the coroutine immediately, on the calling thread.
+    struct InlineExecutor {
+        void execute(std::coroutine_handle<> h) const { h.resume(); }
+    };
+
+    template<typename T, typename Executor = InlineExecutor>
+    class AsyncDeque {
+    public:
+        class pop_awaiter;
+
+        // Constructs a new, empty deque that resumes consumers through a
+        // default-constructed executor.
+        AsyncDeque();
+
+        // Constructs a new, empty deque that resumes consumers through
+        // `executor`.
+        explicit AsyncDeque(Executor executor);
+
+        AsyncDeque(const AsyncDeque &) = delete;
+
+        AsyncDeque &operator=(const AsyncDeque &) = delete;
+
+        // Returns true if the deque holds no elements.
+        bool empty() const;
+
+        // Returns the number of elements in the deque (not counting
+        // elements already handed to suspended consumers).
+        size_t size() const;
+
+        // Returns the number of coroutines suspended in `pop_front`.
+        size_t waiting() const;
+
+        // Inserts a new element at the back, or hands it to the oldest
+        // suspended consumer if there is one.
+        void push_back(const T &);
+
+        // Removes the first element and stores it in the argument. Returns
+        // false if the deque is empty.
+        bool try_pop_front(T &);
+
+        // Returns an awaitable that removes and yields the first element,
+        // suspending the awaiting coroutine until there is one.
+        pop_awaiter pop_front();
+
+        class pop_awaiter {
+        public:
+            bool await_ready();
+
+            bool await_suspend(std::coroutine_handle<>);
+
+            T await_resume();
+
+        private:
+            friend class AsyncDeque;
+
+            explicit pop_awaiter(AsyncDeque &owner) : owner_(owner) {}
+
+            AsyncDeque &owner_;
+            std::coroutine_handle<> handle_;
+            std::optional<T> value_;
+        };
+
+    private:
+        // Private member variables:
+        mutable std::mutex mutex_;
+        Deque<T> items_;
+        Deque<pop_awaiter *> waiters_;
+        Executor executor_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, typename Executor>
+    AsyncDeque<T, Executor>::AsyncDeque()
+            : executor_() {}
+
+    template<typename T, typename Executor>
+    AsyncDeque<T, Executor>::AsyncDeque(Executor executor)
+            : executor_(std::move(executor)) {}
+
+    template<typename T, typename Executor>
+    bool AsyncDeque<T, Executor>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename T, typename Executor>
+    size_t AsyncDeque<T, Executor>::size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    template<typename T, typename Executor>
+    size_t AsyncDeque<T, Executor>::waiting() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return waiters_.size();
+    }
+
+    template<typename T, typename Executor>
+    void AsyncDeque<T, Executor>::push_back(const T &value) {
+        pop_awaiter *waiter;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (waiters_.empty()) {
+                items_.push_back(value);
+                return;
+            }
+            waiter = waiters_.front();
+            waiters_.pop_front();
+            waiter->value_.emplace(value);
+        }
+        executor_.execute(waiter->handle_);
+    }
+
+    template<typename T, typename Executor>
+    bool AsyncDeque<T, Executor>::try_pop_front(T &out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (items_.empty())
+            return false;
+        out = items_.front();
+        items_.pop_front();
+        return true;
+    }
+
+    template<typename T, typename Executor>
+    typename AsyncDeque<T, Executor>::pop_awaiter
+    AsyncDeque<T, Executor>::pop_front() {
+        return pop_awaiter(*this);
+    }
+
+    template<typename T, typename Executor>
+    bool AsyncDeque<T, Executor>::pop_awaiter::await_ready() {
+        std::lock_guard<std::mutex> lock(owner_.mutex_);
+        if (owner_.items_.empty())
+            return false;
+        value_.emplace(owner_.items_.front());
+        owner_.items_.pop_front();
+        return true;
+    }
+
+    template<typename T, typename Executor>
+    bool AsyncDeque<T, Executor>::pop_awaiter::await_suspend(
+            std::coroutine_handle<> h) {
+        std::lock_guard<std::mutex> lock(owner_.mutex_);
+        // Another thread may have pushed since `await_ready`.
+        if (!owner_.items_.empty()) {
+            value_.emplace(owner_.items_.front());
+            owner_.items_.pop_front();
+            return false;
+        }
+        handle_ = h;
+        owner_.waiters_.push_back(this);
+        return true;
+    }
+
+    template<typename T, typename Executor>
+    T AsyncDeque<T, Executor>::pop_awaiter::await_resume() {
+        return std::move(*value_);
+    }
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+/*
+ * A deque of bits, packed 64 to a word in a growable ring of words, for
+ * rolling windows of flags where a `Deque<bool>` would spend a heap node
+ * on every bit. It supports the usual operations at both ends plus
+ * random access, and the queries that benefit from packing: `count` sums
+ * whole words with popcount, and `find_first`/`find_last` skip whole
+ * words and locate the bit with a count-trailing/leading-zeros
+ * instruction.
+ *
+ * The ring holds a power-of-two number of words. When it is full it
+ * doubles by copying its words into both halves of the new ring, which
+ * keeps the bits contiguous from the current head without shifting.
+ *
+ * This is a separate class rather than a `Deque<bool>` specialization so
+ * that `Deque<bool>` keeps handing out real `bool &` references.
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+
+namespace ipd {
+
+    class BitDeque {
+    public:
+        // Returned by `find_first` and `find_last` when there is no match.
+        // An enumerator rather than a static member, so that it needs no
+        // out-of-line definition when bound to a reference.
+        enum : size_t { npos = ~size_t(0) };
+
+        // Constructs a new, empty deque.
+        BitDeque();
+
+        // Constructs a deque with the given bits;
+        BitDeque(std::initializer_list<bool>);
+
+        // Copy constructor.
+        BitDeque(const BitDeque &);
+
+        // Copy-assignment operator.
+        BitDeque &operator=(const BitDeque &);
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of bits in the deque.
+        size_t size() const;
+
+        // Returns the first bit. If the deque is empty then the behavior is
+        // undefined.
+        bool front() const;
+
+        // Returns the last bit. If the deque is empty then the behavior is
+        // undefined.
+        bool back() const;
+
+        // Returns bit `i`, counting from the front. Undefined if `i >= size()`.
+        bool operator[](size_t i) const;
+
+        // Sets bit `i`, counting from the front. Undefined if `i >= size()`.
+        void set(size_t i, bool value);
+
+        // Inserts a new bit at the front of the deque.
+        void push_front(bool);
+
+        // Inserts a new bit at the back of the deque.
+        void push_back(bool);
+
+        // Removes the first bit of the deque. Does nothing if the deque is
+        // empty.
+        void pop_front();
+
+        // Removes the last bit of the deque. Does nothing if the deque is
+        // empty.
+        void pop_back();
+
+        // Removes all bits from the deque. Keeps the ring.
+        void clear();
+
+        // Returns the number of bits that are set.
+        size_t count() const;
+
+        // Returns the index of the first bit equal to `value`, or npos.
+        size_t find_first(bool value = true) const;
+
+        // Returns the index of the last bit equal to `value`, or npos.
+        size_t find_last(bool value = true) const;
+
+    private:
+        static constexpr size_t word_bits_ = 64;
+
+        // Returns a word with the low `n` bits set, for n in [1, 64].
+        static uint64_t low_mask_(size_t n) {
+            return n == word_bits_ ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+        }
+
+        static size_t popcount_(uint64_t);
+
+        // Index of the lowest / highest set bit of a non-zero word.
+        static size_t lowest_bit_(uint64_t);
+
+        static size_t highest_bit_(uint64_t);
+
+        // Maps logical index i to a physical bit position in the ring.
+        size_t pos_(size_t i) const {
+            return (head_ + i) & (capacity_bits_() - 1);
+        }
+
+        size_t capacity_bits_() const { return words_ * word_bits_; }
+
+        // Doubles the ring.
+        void grow_();
+
+        // Private member variables:
+        std::unique_ptr<uint64_t[]> ring_;
+        size_t words_;
+        size_t head_;
+        size_t size_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    inline BitDeque::BitDeque()
+            : words_(0), head_(0), size_(0) {}
+
+    inline BitDeque::BitDeque(std::initializer_list<bool> args)
+            : BitDeque() {
+        for (bool arg : args)
+            push_back(arg);
+    }
+
+    inline BitDeque::BitDeque(const BitDeque &other)
+            : ring_(other.words_ == 0 ? nullptr : new uint64_t[other.words_]),
+              words_(other.words_), head_(other.head_), size_(other.size_) {
+        for (size_t w = 0; w < words_; ++w)
+            ring_[w] = other.ring_[w];
+    }
+
+    inline BitDeque &BitDeque::operator=(const BitDeque &other) {
+        if (this != &other) {
+            BitDeque copy(other);
+            ring_.swap(copy.ring_);
+            words_ = copy.words_;
+            head_ = copy.head_;
+            size_ = copy.size_;
+        }
+        return *this;
+    }
+
+    inline bool BitDeque::empty() const {
+        return size_ == 0;
+    }
+
+    inline size_t BitDeque::size() const {
+        return size_;
+    }
+
+    inline bool BitDeque::front() const {
+        return (*this)[0];
+    }
+
+    inline bool BitDeque::back() const {
+        return (*this)[size_ - 1];
+    }
+
+    inline bool BitDeque::operator[](size_t i) const {
+        assert(i < size_);
+        size_t p = pos_(i);
+        return (ring_[p / word_bits_] >> (p % word_bits_)) & 1;
+    }
+
+    inline void BitDeque::set(size_t i, bool value) {
+        assert(i < size_);
+        size_t p = pos_(i);
+        uint64_t bit = uint64_t(1) << (p % word_bits_);
+        if (value)
+            ring_[p / word_bits_] |= bit;
+        else
+            ring_[p / word_bits_] &= ~bit;
+    }
+
+    inline void BitDeque::push_front(bool value) {
+        if (size_ == capacity_bits_())
+            grow_();
+        head_ = pos_(capacity_bits_() - 1);
+        size_++;
+        set(0, value);
+    }
+
+    inline void BitDeque::push_back(bool value) {
+        if (size_ == capacity_bits_())
+            grow_();
+        size_++;
+        set(size_ - 1, value);
+    }
+
+    inline void BitDeque::pop_front() {
+        if (empty())
+            return;
+        head_ = pos_(1);
+        size_--;
+    }
+
+    inline void BitDeque::pop_back() {
+        if (empty())
+            return;
+        size_--;
+    }
+
+    inline void BitDeque::clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    inline size_t BitDeque::count() const {
+        size_t total = 0;
+        // Walk the ring one word-aligned segment at a time.
+        for (size_t i = 0; i < size_;) {
+            size_t p = pos_(i);
+            size_t lo = p % word_bits_;
+            size_t n = word_bits_ - lo < size_ - i ? word_bits_ - lo : size_ - i;
+            total += popcount_((ring_[p / word_bits_] >> lo) & low_mask_(n));
+            i += n;
+        }
+        return total;
+    }
+
+    inline size_t BitDeque::find_first(bool value) const {
+        uint64_t flip = value ? 0 : ~uint64_t(0);
+        for (size_t i = 0; i < size_;) {
+            size_t p = pos_(i);
+            size_t lo = p % word_bits_;
+            size_t n = word_bits_ - lo < size_ - i ? word_bits_ - lo : size_ - i;
+            uint64_t bits = ((ring_[p / word_bits_] ^ flip) >> lo) & low_mask_(n);
+            if (bits != 0)
+                return i + lowest_bit_(bits);
+            i += n;
+        }
+        return npos;
+    }
+
+    inline size_t BitDeque::find_last(bool value) const {
+        uint64_t flip = value ? 0 : ~uint64_t(0);
+        // `end` is one past the last logical index still to be searched.
+        for (size_t end = size_; end > 0;) {
+            size_t p = pos_(end - 1);
+            size_t hi = p % word_bits_;
+            size_t n = hi + 1 < end ? hi + 1 : end;
+            size_t lo = hi + 1 - n;
+            uint64_t bits = ((ring_[p / word_bits_] ^ flip) >> lo) & low_mask_(n);
+            if (bits != 0)
+                return end - n + highest_bit_(bits);
+            end -= n;
+        }
+        return npos;
+    }
+
+    inline size_t BitDeque::popcount_(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return size_t(__builtin_popcountll(x));
+#else
+        size_t n = 0;
+        for (; x != 0; x &= x - 1)
+            n++;
+        return n;
+#endif
+    }
+
+    inline size_t BitDeque::lowest_bit_(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return size_t(__builtin_ctzll(x));
+#else
+        size_t n = 0;
+        for (; (x & 1) == 0; x >>= 1)
+            n++;
+        return n;
+#endif
+    }
+
+    inline size_t BitDeque::highest_bit_(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return word_bits_ - 1 - size_t(__builtin_clzll(x));
+#else
+        size_t n = 0;
+        while (x >>= 1)
+            n++;
+        return n;
+#endif
+    }
+
+    inline void BitDeque::grow_() {
+        size_t words = words_ == 0 ? 1 : 2 * words_;
+        std::unique_ptr<uint64_t[]> ring(new uint64_t[words]());
+        // The ring is full, so its bits run from head_ all the way around.
+        // With a copy of the old words in each half of the new ring they
+        // run from head_ to head_ + old capacity without wrapping.
+        for (size_t w = 0; w < words_; ++w) {
+            ring[w] = ring_[w];
+            ring[w + words_] = ring_[w];
+        }
+        ring_.swap(ring);
+        words_ = words;
+    }
+}
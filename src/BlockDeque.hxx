@@ -0,0 +1,363 @@
+#pragma once
+
+/*
+ * A deque that stores its elements in fixed-size blocks of `B` slots,
+ * with copy-on-write sharing of blocks between copies. Copying a
+ * `BlockDeque` copies only its list of block references, O(n / B), and
+ * no elements; a block is cloned the first time a copy writes to it while
+ * another copy still refers to it. A copy that is only read never pays
+ * for more than the block list.
+ *
+ * Each entry of the block list is a view, [begin, end), into a reference-
+ * counted block; the block itself records which of its slots hold
+ * constructed elements. Popping only narrows the view, so pops never
+ * clone: if the block is shared, the element stays alive for the other
+ * copies, and if not, it is destroyed on the spot. Pushing, and mutable
+ * access through `front` and `back`, first make the block unique.
+ *
+ * Different copies may be used from different threads; a single copy
+ * may not. Blocks carry their own atomic reference count, and a copy
+ * checks that it is the only owner with an acquire load, so writing to
+ * a block in place is ordered after every other copy's last access to it.
+ */
+
+#include "Deque.hxx"
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ipd {
+
+    template<typename T, size_t B = 64>
+    class BlockDeque {
+        static_assert(B > 0, "BlockDeque block size must be positive");
+
+        struct span_;
+
+    public:
+        class const_iterator;
+
+        // Constructs a new, empty deque.
+        BlockDeque();
+
+        // Constructs a deque with the given elements;
+        BlockDeque(std::initializer_list<T>);
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns a reference to the first element of the deque. If the deque is
+        // empty then the behavior is undefined. The non-const overload first
+        // unshares the element's block.
+        const T &front() const;
+
+        T &front();
+
+        // Returns a reference to the last element of the deque. If the deque is
+        // empty then the behavior is undefined. The non-const overload first
+        // unshares the element's block.
+        const T &back() const;
+
+        T &back();
+
+        // Returns a read-only iterator to the first element.
+        const_iterator begin() const;
+
+        // Returns a read-only iterator one past the last element.
+        const_iterator end() const;
+
+        // Inserts a new element at the front of the deque.
+        void push_front(const T &);
+
+        // Inserts a new element at the back of the deque.
+        void push_back(const T &);
+
+        // Removes the first element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_front();
+
+        // Removes the last element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_back();
+
+        // Removes all elements from the deque.
+        void clear();
+
+        // A forward iterator over the elements, front to back.
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T *;
+            using reference = const T &;
+
+            const_iterator() : slot_(0) {}
+
+            reference operator*() const { return blk_->block->at(slot_); }
+
+            pointer operator->() const { return &**this; }
+
+            const_iterator &operator++() {
+                if (++slot_ == blk_->end) {
+                    ++blk_;
+                    slot_ = blk_ == blk_end_ ? 0 : blk_->begin;
+                }
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator result(*this);
+                ++*this;
+                return result;
+            }
+
+            bool operator==(const const_iterator &other) const {
+                return blk_ == other.blk_ && slot_ == other.slot_;
+            }
+
+            bool operator!=(const const_iterator &other) const {
+                return !(*this == other);
+            }
+
+        private:
+            friend class BlockDeque;
+
+            using span_iterator = typename Deque<span_>::const_iterator;
+
+            const_iterator(span_iterator blk, span_iterator blk_end, size_t slot)
+                    : blk_(blk), blk_end_(blk_end), slot_(slot) {}
+
+            span_iterator blk_;
+            span_iterator blk_end_;
+            size_t slot_;
+        };
+
+    private:
+        // A block of B slots. Slots [lo, hi) hold constructed elements.
+        struct block_ {
+            explicit block_(size_t at) : refs(1), lo(at), hi(at) {}
+
+            block_(const block_ &) = delete;
+
+            block_ &operator=(const block_ &) = delete;
+
+            T &at(size_t i) { return *reinterpret_cast<T *>(&slots[i]); }
+
+            // Destroys the elements in [from, to).
+            void destroy(size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i)
+                    at(i).~T();
+            }
+
+            ~block_() { destroy(lo, hi); }
+
+            // The number of `block_ref_`s to this block.
+            std::atomic<size_t> refs;
+            size_t lo;
+            size_t hi;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[B];
+        };
+
+        // An owning reference to a block. Unlike `std::shared_ptr`, whose
+        // `use_count` is only a relaxed load, `unique` synchronizes with the
+        // release of every other reference, so the caller may then write.
+        class block_ref_ {
+        public:
+            explicit block_ref_(block_ *p) : p_(p) {}
+
+            block_ref_(const block_ref_ &other) : p_(other.p_) {
+                p_->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            block_ref_ &operator=(block_ref_ other) {
+                std::swap(p_, other.p_);
+                return *this;
+            }
+
+            ~block_ref_() {
+                if (p_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    delete p_;
+            }
+
+            bool unique() const {
+                return p_->refs.load(std::memory_order_acquire) == 1;
+            }
+
+            block_ *operator->() const { return p_; }
+
+            block_ &operator*() const { return *p_; }
+
+        private:
+            block_ *p_;
+        };
+
+        // This deque's view of a block: the elements in [begin, end).
+        struct span_ {
+            block_ref_ block;
+            size_t begin;
+            size_t end;
+        };
+
+        // Makes `s.block` referenced only by `s`, cloning its viewed
+        // elements if it is shared, and destroys any elements outside the
+        // view.
+        static void make_unique_(span_ &s);
+
+        // Private member variables:
+        Deque<span_> blocks_;
+        size_t size_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, size_t B>
+    BlockDeque<T, B>::BlockDeque()
+            : size_(0) {}
+
+    template<typename T, size_t B>
+    BlockDeque<T, B>::BlockDeque(std::initializer_list<T> args)
+            : BlockDeque() {
+        for (const auto &arg : args)
+            push_back(arg);
+    }
+
+    template<typename T, size_t B>
+    bool BlockDeque<T, B>::empty() const {
+        return size_ == 0;
+    }
+
+    template<typename T, size_t B>
+    size_t BlockDeque<T, B>::size() const {
+        return size_;
+    }
+
+    template<typename T, size_t B>
+    const T &BlockDeque<T, B>::front() const {
+        const span_ &s = blocks_.front();
+        return s.block->at(s.begin);
+    }
+
+    template<typename T, size_t B>
+    T &BlockDeque<T, B>::front() {
+        span_ &s = blocks_.front();
+        make_unique_(s);
+        return s.block->at(s.begin);
+    }
+
+    template<typename T, size_t B>
+    const T &BlockDeque<T, B>::back() const {
+        const span_ &s = blocks_.back();
+        return s.block->at(s.end - 1);
+    }
+
+    template<typename T, size_t B>
+    T &BlockDeque<T, B>::back() {
+        span_ &s = blocks_.back();
+        make_unique_(s);
+        return s.block->at(s.end - 1);
+    }
+
+    template<typename T, size_t B>
+    typename BlockDeque<T, B>::const_iterator BlockDeque<T, B>::begin() const {
+        if (empty())
+            return end();
+        return const_iterator(blocks_.begin(), blocks_.end(), blocks_.front().begin);
+    }
+
+    template<typename T, size_t B>
+    typename BlockDeque<T, B>::const_iterator BlockDeque<T, B>::end() const {
+        return const_iterator(blocks_.end(), blocks_.end(), 0);
+    }
+
+    template<typename T, size_t B>
+    void BlockDeque<T, B>::push_front(const T &value) {
+        if (empty() || blocks_.front().begin == 0)
+            blocks_.push_front(span_{block_ref_(new block_(B)), B, B});
+
+        span_ &s = blocks_.front();
+        make_unique_(s);
+        ::new(static_cast<void *>(&s.block->slots[s.begin - 1])) T(value);
+        s.block->lo = --s.begin;
+        size_++;
+    }
+
+    template<typename T, size_t B>
+    void BlockDeque<T, B>::push_back(const T &value) {
+        if (empty() || blocks_.back().end == B)
+            blocks_.push_back(span_{block_ref_(new block_(0)), 0, 0});
+
+        span_ &s = blocks_.back();
+        make_unique_(s);
+        ::new(static_cast<void *>(&s.block->slots[s.end])) T(value);
+        s.block->hi = ++s.end;
+        size_++;
+    }
+
+    template<typename T, size_t B>
+    void BlockDeque<T, B>::pop_front() {
+        if (empty())
+            return;
+        span_ &s = blocks_.front();
+        if (s.block.unique()) {
+            make_unique_(s);
+            s.block->destroy(s.begin, s.begin + 1);
+            s.block->lo = s.begin + 1;
+        }
+        if (++s.begin == s.end)
+            blocks_.pop_front();
+        size_--;
+    }
+
+    template<typename T, size_t B>
+    void BlockDeque<T, B>::pop_back() {
+        if (empty())
+            return;
+        span_ &s = blocks_.back();
+        if (s.block.unique()) {
+            make_unique_(s);
+            s.block->destroy(s.end - 1, s.end);
+            s.block->hi = s.end - 1;
+        }
+        if (--s.end == s.begin)
+            blocks_.pop_back();
+        size_--;
+    }
+
+    template<typename T, size_t B>
+    void BlockDeque<T, B>::clear() {
+        blocks_.clear();
+        size_ = 0;
+    }
+
+    template<typename T, size_t B>
+    void BlockDeque<T, B>::make_unique_(span_ &s) {
+        block_ &b = *s.block;
+        if (s.block.unique()) {
+            // Elements outside the view were left behind by pops while the
+            // block was shared; nobody can see them any more.
+            b.destroy(b.lo, s.begin);
+            b.destroy(s.end, b.hi);
+            b.lo = s.begin;
+            b.hi = s.end;
+            return;
+        }
+
+        block_ref_ clone(new block_(s.begin));
+        for (size_t i = s.begin; i < s.end; ++i) {
+            ::new(static_cast<void *>(&clone->slots[i])) T(b.at(i));
+            clone->hi = i + 1;
+        }
+        s.block = std::move(clone);
+    }
+}
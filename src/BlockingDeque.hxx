@@ -0,0 +1,347 @@
+#pragma once
+
+/*
+ * A bounded, thread-safe deque for handing elements between pipeline
+ * stages. Producers block while the deque is full and consumers block
+ * while it is empty. Every push wakes at most one waiting consumer and
+ * every pop wakes at most one waiting producer, and only when somebody is
+ * actually waiting, so there are no thundering-herd wakeups. The bulk
+ * operations move a whole batch under a single lock acquisition and wake
+ * at most one waiter per element moved. `close()` shuts the deque down:
+ * pushes fail from then on, and consumers drain what is left before their
+ * pops start failing.
+ */
+
+#include "Deque.hxx"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace ipd {
+
+    template<typename T>
+    class BlockingDeque {
+    public:
+        // Constructs a new, empty deque that holds at most `capacity`
+        // elements. A capacity of 0 is treated as 1.
+        explicit BlockingDeque(size_t capacity);
+
+        BlockingDeque(const BlockingDeque &) = delete;
+
+        BlockingDeque &operator=(const BlockingDeque &) = delete;
+
+        // Returns the maximum number of elements.
+        size_t capacity() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns true once `close()` has been called.
+        bool closed() const;
+
+        // Inserts a new element at the back, waiting while the deque is
+        // full. Returns false (without inserting) if the deque is closed.
+        bool push_back(const T &);
+
+        // Inserts a new element at the back if there is room. Returns false
+        // if the deque is full or closed.
+        bool try_push_back(const T &);
+
+        // Like `push_back`, but gives up and returns false after waiting
+        // for `timeout`.
+        template<typename Rep, typename Period>
+        bool push_back_for(const T &,
+                           const std::chrono::duration<Rep, Period> &timeout);
+
+        // Removes the first element and stores it in the argument, waiting
+        // while the deque is empty. Returns false if the deque is closed
+        // and has been drained.
+        bool pop_front(T &);
+
+        // Removes the first element and stores it in the argument if there
+        // is one. Returns false if the deque is empty.
+        bool try_pop_front(T &);
+
+        // Like `pop_front`, but gives up and returns false after waiting
+        // for `timeout`.
+        template<typename Rep, typename Period>
+        bool pop_front_for(T &,
+                           const std::chrono::duration<Rep, Period> &timeout);
+
+        // Inserts elements from [first, last) at the back, waiting while the
+        // deque is full. Each time it gets the lock it inserts as many
+        // elements as fit. Returns the number inserted, which is less than
+        // the length of the range only if the deque was closed.
+        template<typename InputIt>
+        size_t push_back_bulk(InputIt first, InputIt last);
+
+        // Inserts as many elements from [first, last) as fit, under one lock
+        // acquisition and without waiting. Returns the number inserted.
+        template<typename InputIt>
+        size_t try_push_back_bulk(InputIt first, InputIt last);
+
+        // Removes up to `max` elements from the front and writes them to
+        // `out`, waiting while the deque is empty. Returns the number
+        // removed, which is 0 only if the deque is closed and drained (or
+        // `max` is 0).
+        template<typename OutputIt>
+        size_t pop_front_bulk(OutputIt out, size_t max);
+
+        // Removes up to `max` elements from the front, under one lock
+        // acquisition and without waiting, and writes them to `out`.
+        // Returns the number removed.
+        template<typename OutputIt>
+        size_t try_pop_front_bulk(OutputIt out, size_t max);
+
+        // Closes the deque and wakes every waiter. Elements already in the
+        // deque can still be popped.
+        void close();
+
+    private:
+        // Helpers that assume `mutex_` is held and that there is room
+        // (respectively an element).
+        void do_push_(const T &);
+
+        void do_pop_(T &);
+
+        // Bulk versions of the above: move as many elements as fit (or as
+        // are available), then wake up to that many waiters. Return the
+        // number of elements moved.
+        template<typename InputIt>
+        size_t do_push_bulk_(InputIt &first, InputIt last);
+
+        template<typename OutputIt>
+        size_t do_pop_bulk_(OutputIt &out, size_t max);
+
+        // Wakes up to `n` of the `waiting` threads blocked on `cv`.
+        static void wake_(std::condition_variable &cv, size_t waiting,
+                          size_t n);
+
+        // Private member variables:
+        mutable std::mutex mutex_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+        Deque<T> items_;
+        size_t capacity_;
+        size_t waiting_producers_;
+        size_t waiting_consumers_;
+        bool closed_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T>
+    BlockingDeque<T>::BlockingDeque(size_t capacity)
+            : capacity_(capacity == 0 ? 1 : capacity),
+              waiting_producers_(0), waiting_consumers_(0), closed_(false) {}
+
+    template<typename T>
+    size_t BlockingDeque<T>::capacity() const {
+        return capacity_;
+    }
+
+    template<typename T>
+    size_t BlockingDeque<T>::size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    template<typename T>
+    bool BlockingDeque<T>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename T>
+    bool BlockingDeque<T>::closed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+    template<typename T>
+    bool BlockingDeque<T>::push_back(const T &value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++waiting_producers_;
+        not_full_.wait(lock, [this] {
+            return closed_ || items_.size() < capacity_;
+        });
+        --waiting_producers_;
+        if (closed_)
+            return false;
+        do_push_(value);
+        return true;
+    }
+
+    template<typename T>
+    bool BlockingDeque<T>::try_push_back(const T &value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || items_.size() >= capacity_)
+            return false;
+        do_push_(value);
+        return true;
+    }
+
+    template<typename T>
+    template<typename Rep, typename Period>
+    bool BlockingDeque<T>::push_back_for(
+            const T &value, const std::chrono::duration<Rep, Period> &timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++waiting_producers_;
+        bool ready = not_full_.wait_for(lock, timeout, [this] {
+            return closed_ || items_.size() < capacity_;
+        });
+        --waiting_producers_;
+        if (!ready || closed_)
+            return false;
+        do_push_(value);
+        return true;
+    }
+
+    template<typename T>
+    bool BlockingDeque<T>::pop_front(T &out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++waiting_consumers_;
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        --waiting_consumers_;
+        if (items_.empty())
+            return false;
+        do_pop_(out);
+        return true;
+    }
+
+    template<typename T>
+    bool BlockingDeque<T>::try_pop_front(T &out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (items_.empty())
+            return false;
+        do_pop_(out);
+        return true;
+    }
+
+    template<typename T>
+    template<typename Rep, typename Period>
+    bool BlockingDeque<T>::pop_front_for(
+            T &out, const std::chrono::duration<Rep, Period> &timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++waiting_consumers_;
+        not_empty_.wait_for(lock, timeout, [this] {
+            return closed_ || !items_.empty();
+        });
+        --waiting_consumers_;
+        if (items_.empty())
+            return false;
+        do_pop_(out);
+        return true;
+    }
+
+    template<typename T>
+    template<typename InputIt>
+    size_t BlockingDeque<T>::push_back_bulk(InputIt first, InputIt last) {
+        size_t pushed = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (first != last) {
+            ++waiting_producers_;
+            not_full_.wait(lock, [this] {
+                return closed_ || items_.size() < capacity_;
+            });
+            --waiting_producers_;
+            if (closed_)
+                break;
+            pushed += do_push_bulk_(first, last);
+        }
+        return pushed;
+    }
+
+    template<typename T>
+    template<typename InputIt>
+    size_t BlockingDeque<T>::try_push_back_bulk(InputIt first, InputIt last) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_)
+            return 0;
+        return do_push_bulk_(first, last);
+    }
+
+    template<typename T>
+    template<typename OutputIt>
+    size_t BlockingDeque<T>::pop_front_bulk(OutputIt out, size_t max) {
+        if (max == 0)
+            return 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++waiting_consumers_;
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        --waiting_consumers_;
+        return do_pop_bulk_(out, max);
+    }
+
+    template<typename T>
+    template<typename OutputIt>
+    size_t BlockingDeque<T>::try_pop_front_bulk(OutputIt out, size_t max) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return do_pop_bulk_(out, max);
+    }
+
+    template<typename T>
+    void BlockingDeque<T>::close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    template<typename T>
+    void BlockingDeque<T>::do_push_(const T &value) {
+        items_.push_back(value);
+        if (waiting_consumers_ > 0)
+            not_empty_.notify_one();
+    }
+
+    template<typename T>
+    void BlockingDeque<T>::do_pop_(T &out) {
+        out = items_.front();
+        items_.pop_front();
+        if (waiting_producers_ > 0)
+            not_full_.notify_one();
+    }
+
+    template<typename T>
+    template<typename InputIt>
+    size_t BlockingDeque<T>::do_push_bulk_(InputIt &first, InputIt last) {
+        size_t n = 0;
+        for (; first != last && items_.size() < capacity_; ++first, ++n)
+            items_.push_back(*first);
+        wake_(not_empty_, waiting_consumers_, n);
+        return n;
+    }
+
+    template<typename T>
+    template<typename OutputIt>
+    size_t BlockingDeque<T>::do_pop_bulk_(OutputIt &out, size_t max) {
+        size_t n = 0;
+        for (; n < max && !items_.empty(); ++n, ++out) {
+            *out = items_.front();
+            items_.pop_front();
+        }
+        wake_(not_full_, waiting_producers_, n);
+        return n;
+    }
+
+    template<typename T>
+    void BlockingDeque<T>::wake_(std::condition_variable &cv, size_t waiting,
+                                 size_t n) {
+        if (n >= waiting) {
+            if (waiting > 0)
+                cv.notify_all();
+        } else {
+            for (size_t i = 0; i < n; ++i)
+                cv.notify_one();
+        }
+    }
+}
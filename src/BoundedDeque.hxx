@@ -0,0 +1,289 @@
+#pragma once
+
+/*
+ * A thread-safe FIFO that sheds load when it fills up, for queues in
+ * front of a consumer that can fall behind. What a push does on a full
+ * deque is chosen at compile time by one of the policy tags in
+ * `ipd::overflow`:
+ *
+ *  - `unbounded`:   never full; pushes always succeed.
+ *  - `reject`:      the push fails and returns false; the caller keeps
+ *                   the element and decides what to do.
+ *  - `drop_oldest`: the oldest queued element is discarded to make room.
+ *  - `drop_newest`: the incoming element is discarded, but the push still
+ *                   reports success (fire and forget).
+ *  - `block`:       the push waits for room, like `BlockingDeque`.
+ *
+ * The policy is resolved by overloading on the tag, so each push compiles
+ * to only its own policy's code and `unbounded` does no capacity check at
+ * all. Every deque keeps counters of what its policy shed (or how often
+ * it made producers wait) and the highest size it has reached; `stats`
+ * returns them.
+ *
+ * `close()` shuts the deque down as in `BlockingDeque`: pushes fail from
+ * then on, and consumers drain what is left before their pops fail.
+ */
+
+#include "Deque.hxx"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+namespace ipd {
+
+    namespace overflow {
+        struct unbounded {};
+        struct reject {};
+        struct drop_oldest {};
+        struct drop_newest {};
+        struct block {};
+    }
+
+    // Counters reported by `BoundedDeque::stats`. Only the ones that apply
+    // to the deque's policy ever become non-zero.
+    struct BoundedDequeStats {
+        // Elements accepted by a push, including ones later dropped.
+        uint64_t pushed = 0;
+        // Pushes that failed because the deque was full (`reject`).
+        uint64_t rejected = 0;
+        // Queued elements discarded to make room (`drop_oldest`).
+        uint64_t dropped_oldest = 0;
+        // Incoming elements discarded (`drop_newest`).
+        uint64_t dropped_newest = 0;
+        // Pushes that had to wait for room (`block`).
+        uint64_t blocked = 0;
+        // The largest size the deque has had.
+        size_t high_water = 0;
+    };
+
+    template<typename T, typename Policy = overflow::reject>
+    class BoundedDeque {
+    public:
+        // Constructs a new, empty deque that holds at most `capacity`
+        // elements. A capacity of 0 is treated as 1. Ignored by
+        // `overflow::unbounded`.
+        explicit BoundedDeque(size_t capacity = std::numeric_limits<size_t>::max());
+
+        BoundedDeque(const BoundedDeque &) = delete;
+
+        BoundedDeque &operator=(const BoundedDeque &) = delete;
+
+        // Returns the maximum number of elements.
+        size_t capacity() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns true once `close()` has been called.
+        bool closed() const;
+
+        // Returns a copy of the counters.
+        BoundedDequeStats stats() const;
+
+        // Inserts a new element at the back, applying the policy if the
+        // deque is full. Returns false if the policy refused the element
+        // (`reject`) or the deque is closed.
+        bool push_back(const T &);
+
+        // Removes the first element and stores it in the argument, waiting
+        // while the deque is empty. Returns false if the deque is closed
+        // and has been drained.
+        bool pop_front(T &);
+
+        // Removes the first element and stores it in the argument if there
+        // is one. Returns false if the deque is empty.
+        bool try_pop_front(T &);
+
+        // Closes the deque and wakes every waiter. Elements already in the
+        // deque can still be popped.
+        void close();
+
+    private:
+        // The per-policy halves of `push_back`, called with `mutex_` held
+        // and the deque open. Each returns push_back's result.
+        bool push_(const T &, std::unique_lock<std::mutex> &, overflow::unbounded);
+
+        bool push_(const T &, std::unique_lock<std::mutex> &, overflow::reject);
+
+        bool push_(const T &, std::unique_lock<std::mutex> &, overflow::drop_oldest);
+
+        bool push_(const T &, std::unique_lock<std::mutex> &, overflow::drop_newest);
+
+        bool push_(const T &, std::unique_lock<std::mutex> &, overflow::block);
+
+        // Appends the element and updates the counters. Assumes `mutex_` is
+        // held.
+        void do_push_(const T &);
+
+        void do_pop_(T &);
+
+        // Private member variables:
+        mutable std::mutex mutex_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+        Deque<T> items_;
+        BoundedDequeStats stats_;
+        size_t capacity_;
+        size_t waiting_producers_;
+        size_t waiting_consumers_;
+        bool closed_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, typename Policy>
+    BoundedDeque<T, Policy>::BoundedDeque(size_t capacity)
+            : capacity_(capacity == 0 ? 1 : capacity),
+              waiting_producers_(0), waiting_consumers_(0), closed_(false) {}
+
+    template<typename T, typename Policy>
+    size_t BoundedDeque<T, Policy>::capacity() const {
+        return capacity_;
+    }
+
+    template<typename T, typename Policy>
+    size_t BoundedDeque<T, Policy>::size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::closed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+    template<typename T, typename Policy>
+    BoundedDequeStats BoundedDeque<T, Policy>::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::push_back(const T &value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (closed_)
+            return false;
+        return push_(value, lock, Policy());
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::pop_front(T &out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++waiting_consumers_;
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        --waiting_consumers_;
+        if (items_.empty())
+            return false;
+        do_pop_(out);
+        return true;
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::try_pop_front(T &out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (items_.empty())
+            return false;
+        do_pop_(out);
+        return true;
+    }
+
+    template<typename T, typename Policy>
+    void BoundedDeque<T, Policy>::close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::push_(const T &value, std::unique_lock<std::mutex> &,
+                                        overflow::unbounded) {
+        do_push_(value);
+        return true;
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::push_(const T &value, std::unique_lock<std::mutex> &,
+                                        overflow::reject) {
+        if (items_.size() >= capacity_) {
+            ++stats_.rejected;
+            return false;
+        }
+        do_push_(value);
+        return true;
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::push_(const T &value, std::unique_lock<std::mutex> &,
+                                        overflow::drop_oldest) {
+        if (items_.size() >= capacity_) {
+            items_.pop_front();
+            ++stats_.dropped_oldest;
+        }
+        do_push_(value);
+        return true;
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::push_(const T &value, std::unique_lock<std::mutex> &,
+                                        overflow::drop_newest) {
+        if (items_.size() >= capacity_) {
+            ++stats_.pushed;
+            ++stats_.dropped_newest;
+            return true;
+        }
+        do_push_(value);
+        return true;
+    }
+
+    template<typename T, typename Policy>
+    bool BoundedDeque<T, Policy>::push_(const T &value, std::unique_lock<std::mutex> &lock,
+                                        overflow::block) {
+        if (items_.size() >= capacity_) {
+            ++stats_.blocked;
+            ++waiting_producers_;
+            not_full_.wait(lock, [this] {
+                return closed_ || items_.size() < capacity_;
+            });
+            --waiting_producers_;
+            if (closed_)
+                return false;
+        }
+        do_push_(value);
+        return true;
+    }
+
+    template<typename T, typename Policy>
+    void BoundedDeque<T, Policy>::do_push_(const T &value) {
+        items_.push_back(value);
+        ++stats_.pushed;
+        if (items_.size() > stats_.high_water)
+            stats_.high_water = items_.size();
+        if (waiting_consumers_ > 0)
+            not_empty_.notify_one();
+    }
+
+    template<typename T, typename Policy>
+    void BoundedDeque<T, Policy>::do_pop_(T &out) {
+        out = items_.front();
+        items_.pop_front();
+        if (waiting_producers_ > 0)
+            not_full_.notify_one();
+    }
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+/*
+ * A fixed-capacity ring of the last N events, for always-on flight
+ * recorders. Pushing onto a full log overwrites the oldest event in O(1)
+ * and counts it as dropped; the log lives entirely inside the object and
+ * never allocates.
+ *
+ * One thread, the writer, owns the log and is the only one that may push,
+ * pop or clear. Any number of other threads (or a crash handler) may call
+ * `snapshot` at the same time to copy out the most recent events without
+ * locking and without ever blocking the writer. Each slot carries a
+ * sequence number that is odd while the writer is filling it, as in a
+ * seqlock: a reader copies the event, then checks that the sequence
+ * number is unchanged and names the position it expected. A failed check
+ * means the writer lapped the reader, and the events copied before it are
+ * older still, so the reader discards them and keeps going; the result is
+ * always a run of consecutive, untorn events.
+ *
+ * Events are copied with `memcpy` while the writer may be racing on them,
+ * which is why T must be trivially copyable.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace ipd {
+
+    template<typename T, size_t N>
+    class CircularLog {
+        static_assert(N > 0, "CircularLog capacity must be positive");
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "CircularLog elements must be trivially copyable");
+
+    public:
+        // Constructs a new, empty log.
+        CircularLog();
+
+        CircularLog(const CircularLog &) = delete;
+
+        CircularLog &operator=(const CircularLog &) = delete;
+
+        // Returns the maximum number of elements, N.
+        static constexpr size_t capacity() { return N; }
+
+        // Returns true if the log is empty.
+        bool empty() const;
+
+        // Returns true if the log holds N elements, so the next push drops
+        // the oldest.
+        bool full() const;
+
+        // Returns the number of elements in the log.
+        size_t size() const;
+
+        // Returns the number of elements overwritten by pushes onto a full
+        // log since construction. Safe to call from any thread.
+        uint64_t dropped() const;
+
+        // Returns a reference to the first (oldest) element. If the log is
+        // empty then the behavior is undefined. Writer only.
+        const T &front() const;
+
+        // Returns a reference to the last (newest) element. If the log is
+        // empty then the behavior is undefined. Writer only.
+        const T &back() const;
+
+        // Inserts a new element at the back, overwriting the oldest one if
+        // the log is full. Writer only.
+        void push_back(const T &);
+
+        // Removes the first element of the log. Does nothing if the log is
+        // empty. Writer only.
+        void pop_front();
+
+        // Removes all elements from the log. Writer only.
+        void clear();
+
+        // Copies up to the `max` most recent elements to `out`, oldest
+        // first, and returns how many were copied. Safe to call from any
+        // thread while the writer keeps pushing; may return fewer than
+        // `max` if the writer overwrote some of them mid-copy.
+        size_t snapshot(T *out, size_t max) const;
+
+    private:
+        struct slot_ {
+            // 2 * pos + 2 once the element at position `pos` is complete;
+            // odd while it is being written.
+            std::atomic<uint64_t> seq;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        };
+
+        const T &at_(uint64_t pos) const {
+            return *reinterpret_cast<const T *>(&slots_[pos % N].storage);
+        }
+
+        // Private member variables. Positions count every push since
+        // construction; the log holds positions [tail_, head_).
+        slot_ slots_[N];
+        std::atomic<uint64_t> head_;
+        std::atomic<uint64_t> tail_;
+        std::atomic<uint64_t> dropped_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, size_t N>
+    CircularLog<T, N>::CircularLog()
+            : head_(0), tail_(0), dropped_(0) {
+        for (slot_ &s : slots_)
+            s.seq.store(0, std::memory_order_relaxed);
+    }
+
+    template<typename T, size_t N>
+    bool CircularLog<T, N>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename T, size_t N>
+    bool CircularLog<T, N>::full() const {
+        return size() == N;
+    }
+
+    template<typename T, size_t N>
+    size_t CircularLog<T, N>::size() const {
+        return size_t(head_.load(std::memory_order_relaxed)
+                      - tail_.load(std::memory_order_relaxed));
+    }
+
+    template<typename T, size_t N>
+    uint64_t CircularLog<T, N>::dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    template<typename T, size_t N>
+    const T &CircularLog<T, N>::front() const {
+        return at_(tail_.load(std::memory_order_relaxed));
+    }
+
+    template<typename T, size_t N>
+    const T &CircularLog<T, N>::back() const {
+        return at_(head_.load(std::memory_order_relaxed) - 1);
+    }
+
+    template<typename T, size_t N>
+    void CircularLog<T, N>::push_back(const T &value) {
+        uint64_t pos = head_.load(std::memory_order_relaxed);
+        if (full()) {
+            tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            dropped_.store(dropped() + 1, std::memory_order_relaxed);
+        }
+
+        slot_ &s = slots_[pos % N];
+        s.seq.store(2 * pos + 1, std::memory_order_relaxed);
+        // Orders the odd sequence number before the new bytes, so a reader
+        // that sees any of them also sees that the slot is in flux.
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&s.storage, &value, sizeof(T));
+        s.seq.store(2 * pos + 2, std::memory_order_release);
+        head_.store(pos + 1, std::memory_order_release);
+    }
+
+    template<typename T, size_t N>
+    void CircularLog<T, N>::pop_front() {
+        if (!empty())
+            tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    template<typename T, size_t N>
+    void CircularLog<T, N>::clear() {
+        tail_.store(head_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    template<typename T, size_t N>
+    size_t CircularLog<T, N>::snapshot(T *out, size_t max) const {
+        uint64_t end = head_.load(std::memory_order_acquire);
+        uint64_t begin = tail_.load(std::memory_order_relaxed);
+        if (begin > end)
+            begin = end;
+        if (end - begin > max)
+            begin = end - max;
+
+        size_t count = 0;
+        for (uint64_t pos = begin; pos < end; ++pos) {
+            const slot_ &s = slots_[pos % N];
+            uint64_t before = s.seq.load(std::memory_order_acquire);
+            std::memcpy(static_cast<void *>(&out[count]), &s.storage, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t after = s.seq.load(std::memory_order_relaxed);
+            if (before == after && before == 2 * pos + 2)
+                count++;
+            else
+                count = 0;
+        }
+        return count;
+    }
+}
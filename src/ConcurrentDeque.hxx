@@ -0,0 +1,183 @@
+#pragma once
+
+/*
+ * A lock-free, node-based concurrent deque. Elements are pushed at the
+ * back and popped from the front by any number of threads, using the
+ * Michael-Scott algorithm ("Simple, Fast, and Practical Non-Blocking and
+ * Blocking Concurrent Queue Algorithms", PODC 1996) over the same kind of
+ * linked nodes as `Deque`.
+ *
+ * The list always starts with a dummy node; the first element lives in
+ * the node after it, and popping turns that node into the new dummy.
+ * Unlinked dummies are handed to the `Reclaim` policy instead of being
+ * deleted, so a thread that is still reading one never touches freed
+ * memory, and no node is reused while anyone holds a pointer to it (which
+ * also rules out ABA on the compare-and-swaps).
+ *
+ * `Reclaim` is either `EpochReclaim` (the default; cheapest per
+ * operation) or `HazardReclaim` (bounded garbage even when threads are
+ * descheduled mid-operation). A policy provides a `guard` type, created
+ * once per operation, whose `protect(slot, src)` returns a pointer loaded
+ * from `src` that is safe to dereference, and a static `retire(p)`.
+ */
+
+#include "EpochDomain.hxx"
+#include "HazardDomain.hxx"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ipd {
+
+    template<typename T, typename Reclaim = EpochReclaim>
+    class ConcurrentDeque {
+    public:
+        // Constructs a new, empty deque.
+        ConcurrentDeque();
+
+        ConcurrentDeque(const ConcurrentDeque &) = delete;
+
+        ConcurrentDeque &operator=(const ConcurrentDeque &) = delete;
+
+        // Returns true if the deque appears empty. Only a hint while other
+        // threads are pushing or popping.
+        bool empty() const;
+
+        // Inserts a new element at the back of the deque.
+        void push_back(const T &);
+
+        // Removes the first element and stores it in the argument. Returns
+        // false if the deque was empty.
+        bool try_pop_front(T &);
+
+        // The destructor. No other thread may be using the deque.
+        ~ConcurrentDeque();
+
+    private:
+        // Like `Deque::node_`, but the link is atomic and the value is
+        // optional: the dummy node at the front does not hold a live
+        // element.
+        struct node_ {
+            node_() : next(nullptr), engaged(false) {}
+
+            explicit node_(const T &value) : next(nullptr), engaged(true) {
+                ::new(static_cast<void *>(&storage)) T(value);
+            }
+
+            T &val() { return *reinterpret_cast<T *>(&storage); }
+
+            ~node_() {
+                if (engaged)
+                    val().~T();
+            }
+
+            std::atomic<node_ *> next;
+            bool engaged;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        };
+
+        // Private member variables. Producers hammer `tail_` and consumers
+        // hammer `head_`, so they are padded onto separate cache lines.
+        std::atomic<node_ *> head_;
+        char pad_[64 - sizeof(std::atomic<node_ *>)];
+        std::atomic<node_ *> tail_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, typename Reclaim>
+    ConcurrentDeque<T, Reclaim>::ConcurrentDeque() {
+        node_ *dummy = new node_;
+        head_.store(dummy, std::memory_order_relaxed);
+        tail_.store(dummy, std::memory_order_relaxed);
+    }
+
+    template<typename T, typename Reclaim>
+    bool ConcurrentDeque<T, Reclaim>::empty() const {
+        typename Reclaim::guard guard;
+        node_ *head = guard.protect(0, head_);
+        return head->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    template<typename T, typename Reclaim>
+    void ConcurrentDeque<T, Reclaim>::push_back(const T &value) {
+        node_ *newNode = new node_(value);
+        typename Reclaim::guard guard;
+
+        for (;;) {
+            node_ *tail = guard.protect(0, tail_);
+            node_ *next = tail->next.load(std::memory_order_acquire);
+            if (tail != tail_.load(std::memory_order_acquire))
+                continue;
+
+            if (next != nullptr) {
+                // The tail is lagging behind; help swing it forward.
+                tail_.compare_exchange_weak(tail, next,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed);
+                continue;
+            }
+
+            if (tail->next.compare_exchange_weak(next, newNode,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+                tail_.compare_exchange_strong(tail, newNode,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    template<typename T, typename Reclaim>
+    bool ConcurrentDeque<T, Reclaim>::try_pop_front(T &out) {
+        typename Reclaim::guard guard;
+
+        for (;;) {
+            node_ *head = guard.protect(0, head_);
+            node_ *tail = tail_.load(std::memory_order_acquire);
+            node_ *next = guard.protect(1, head->next);
+            // Re-checking the head after protecting `next` guarantees that
+            // `next` had not been popped and retired when we published it.
+            if (head != head_.load(std::memory_order_acquire))
+                continue;
+
+            if (next == nullptr)
+                return false;
+
+            if (head == tail) {
+                tail_.compare_exchange_weak(tail, next,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed);
+                continue;
+            }
+
+            // Copy before the CAS: once it succeeds, another consumer may
+            // pop `next` in turn and retire it.
+            T value = next->val();
+            if (head_.compare_exchange_weak(head, next,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+                out = std::move(value);
+                guard.reset(0);
+                Reclaim::retire(head);
+                return true;
+            }
+        }
+    }
+
+    template<typename T, typename Reclaim>
+    ConcurrentDeque<T, Reclaim>::~ConcurrentDeque() {
+        node_ *curr = head_.load(std::memory_order_relaxed);
+        while (curr != nullptr) {
+            node_ *next = curr->next.load(std::memory_order_relaxed);
+            delete curr;
+            curr = next;
+        }
+    }
+}
@@ -4,12 +4,47 @@
  * A deque (pronounced like "deck") is a double-ended queue. This file
  * This file contains an implementation of a deque represented as a
  * doubly-linked list.
+ *
+ * Under C++20 (with constexpr dynamic allocation) every operation is
+ * constexpr, so a `Deque` can be built, traversed and destroyed during
+ * constant evaluation, e.g. to run a BFS that fills a lookup table at
+ * compile time. Under earlier standards IPD_CONSTEXPR expands to nothing.
+ *
+ * Each node keeps its links ahead of the element, so following a link and
+ * reading the start of a large element touch the same cache line. Defining
+ * IPD_DEQUE_NODE_ALIGN (e.g. to 64) aligns every node to that boundary,
+ * which needs C++17 aligned `new`. Traversals (iteration, copy and clear)
+ * prefetch the following node while working on the current one; define
+ * IPD_DEQUE_PREFETCH to 0 to turn that off.
  */
 
 #include <cstddef>
 #include <initializer_list>
+#include <iterator>
+#include <type_traits>
 #include <utility>
 
+#if defined(__cpp_constexpr_dynamic_alloc) && __cpp_constexpr_dynamic_alloc >= 201907L
+#define IPD_CONSTEXPR constexpr
+#define IPD_CONSTEXPR_ALLOC 1
+#else
+#define IPD_CONSTEXPR
+#define IPD_CONSTEXPR_ALLOC 0
+#endif
+
+#ifndef IPD_DEQUE_PREFETCH
+#define IPD_DEQUE_PREFETCH 1
+#endif
+
+#ifdef IPD_DEQUE_NODE_ALIGN
+#if !defined(__cpp_aligned_new)
+#error "IPD_DEQUE_NODE_ALIGN requires C++17 aligned new"
+#endif
+#define IPD_DEQUE_NODE_ALIGNAS_ alignas(IPD_DEQUE_NODE_ALIGN)
+#else
+#define IPD_DEQUE_NODE_ALIGNAS_
+#endif
+
 namespace ipd {
 //
 // The main `Deque` class
@@ -17,74 +52,184 @@ namespace ipd {
 
     template<typename T>
     class Deque {
+        struct node_;
+
     public:
+        template<typename Value, typename Node>
+        class basic_iterator_;
+
+        // Bidirectional iterators over the elements, front to back.
+        using iterator = basic_iterator_<T, node_>;
+        using const_iterator = basic_iterator_<const T, const node_>;
+
         // Constructs a new, empty deque.
-        Deque();
+        IPD_CONSTEXPR Deque();
 
         // Constructs a deque with the given elements;
-        Deque(std::initializer_list<T>);
+        IPD_CONSTEXPR Deque(std::initializer_list<T>);
 
         // Copy constructor.
-        Deque(const Deque &);
+        IPD_CONSTEXPR Deque(const Deque &);
 
         // Copy-assignment operator.
-        Deque &operator=(const Deque &);
+        IPD_CONSTEXPR Deque &operator=(const Deque &);
 
         // Returns true if the deque is empty.
-        bool empty() const;
+        IPD_CONSTEXPR bool empty() const;
 
         // Returns the number of elements in the deque.
-        size_t size() const;
+        IPD_CONSTEXPR size_t size() const;
 
         // Returns a reference to the first element of the deque. If the deque is
         // empty then the behavior is undefined.
-        const T &front() const;
+        IPD_CONSTEXPR const T &front() const;
 
-        T &front();
+        IPD_CONSTEXPR T &front();
 
         // Returns a reference to the last element of the deque. If the deque is
         // empty then the behavior is undefined.
-        const T &back() const;
+        IPD_CONSTEXPR const T &back() const;
+
+        IPD_CONSTEXPR T &back();
+
+        // Returns an iterator to the first element.
+        IPD_CONSTEXPR iterator begin();
+
+        IPD_CONSTEXPR const_iterator begin() const;
+
+        // Returns an iterator one past the last element.
+        IPD_CONSTEXPR iterator end();
 
-        T &back();
+        IPD_CONSTEXPR const_iterator end() const;
 
         // Inserts a new element at the front of the deque.
-        void push_front(const T &);
+        IPD_CONSTEXPR void push_front(const T &);
 
         // Inserts a new element at the back of the deque.
-        void push_back(const T &);
+        IPD_CONSTEXPR void push_back(const T &);
 
         // Removes the first element of the deque. Undefined if the
         // deque is empty.
-        void pop_front();
+        IPD_CONSTEXPR void pop_front();
 
         // Removes the last element of the deque. Undefined if the
         // deque is empty.
-        void pop_back();
+        IPD_CONSTEXPR void pop_back();
 
         // Removes all elements from the deque.
-        void clear();
+        IPD_CONSTEXPR void clear();
 
-        void splice(Deque<T> &);
+        IPD_CONSTEXPR void splice(Deque<T> &);
+
+        // Exchanges the contents of this deque and `that` in O(1).
+        IPD_CONSTEXPR void swap(Deque<T> &that) noexcept;
 
         // The destructor.
-        ~Deque();
+        IPD_CONSTEXPR ~Deque();
+
+        // The iterator type. It remembers its deque so that decrementing
+        // `end()` reaches the last element.
+        template<typename Value, typename Node>
+        class basic_iterator_ {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value *;
+            using reference = Value &;
+
+            IPD_CONSTEXPR basic_iterator_() : curr_(nullptr), owner_(nullptr) {}
+
+            // Converts an iterator to a const_iterator.
+            template<typename OtherValue, typename OtherNode,
+                    typename = typename std::enable_if<
+                            std::is_convertible<OtherNode *, Node *>::value>::type>
+            IPD_CONSTEXPR basic_iterator_(
+                    const basic_iterator_<OtherValue, OtherNode> &other)
+                    : curr_(other.curr_), owner_(other.owner_) {}
+
+            IPD_CONSTEXPR reference operator*() const { return curr_->val; }
+
+            IPD_CONSTEXPR pointer operator->() const { return &curr_->val; }
+
+            IPD_CONSTEXPR basic_iterator_ &operator++() {
+                curr_ = curr_->next;
+                if (curr_ != nullptr)
+                    prefetch_(curr_->next);
+                return *this;
+            }
+
+            IPD_CONSTEXPR basic_iterator_ operator++(int) {
+                basic_iterator_ result(*this);
+                ++*this;
+                return result;
+            }
+
+            IPD_CONSTEXPR basic_iterator_ &operator--() {
+                curr_ = curr_ == nullptr ? owner_->tail_ : curr_->prev;
+                return *this;
+            }
+
+            IPD_CONSTEXPR basic_iterator_ operator--(int) {
+                basic_iterator_ result(*this);
+                --*this;
+                return result;
+            }
+
+            IPD_CONSTEXPR bool operator==(const basic_iterator_ &other) const {
+                return curr_ == other.curr_;
+            }
+
+            IPD_CONSTEXPR bool operator!=(const basic_iterator_ &other) const {
+                return curr_ != other.curr_;
+            }
+
+        private:
+            friend class Deque;
+
+            template<typename, typename>
+            friend class basic_iterator_;
+
+            IPD_CONSTEXPR basic_iterator_(Node *curr, const Deque *owner)
+                    : curr_(curr), owner_(owner) {}
+
+            Node *curr_;
+            const Deque *owner_;
+        };
 
     private:
-        // The linked list is made out of nodes, each of which contains a data
-        // element (val) and pointers to next and previous nodes.
-        struct node_ {
-            T val;
+        // The linked list is made out of nodes, each of which contains pointers
+        // to next and previous nodes and a data element (val). The links come
+        // first: they are what every traversal reads, and with them at offset
+        // 0 a large or over-aligned element cannot push them onto another
+        // cache line. For small elements the order makes no difference to
+        // the node's size.
+        struct IPD_DEQUE_NODE_ALIGNAS_ node_ {
             node_ *prev;
             node_ *next;
+            T val;
 
             // Constructs a new node, forwarding the arguments to construct the
             // data element. The prev and next pointers are initialized to nullptr.
             template<typename... Args>
-            explicit node_(Args &&... args)
-                    : val(std::forward<Args>(args)...), prev(nullptr), next(nullptr) {}
+            IPD_CONSTEXPR explicit node_(Args &&... args)
+                    : prev(nullptr), next(nullptr), val(std::forward<Args>(args)...) {}
         };
 
+        // Hints that `p` (which may be null) will be read soon. A no-op
+        // during constant evaluation.
+        static IPD_CONSTEXPR void prefetch_(const node_ *p) {
+#if IPD_DEQUE_PREFETCH && (defined(__GNUC__) || defined(__clang__))
+#if IPD_CONSTEXPR_ALLOC
+            if (__builtin_is_constant_evaluated())
+                return;
+#endif
+            __builtin_prefetch(p);
+#else
+            (void) p;
+#endif
+        }
+
         // Private member variables:
         node_ *head_;
         node_ *tail_;
@@ -97,29 +242,33 @@ namespace ipd {
 ///
 
     template<typename T>
-    Deque<T>::Deque()
+    IPD_CONSTEXPR Deque<T>::Deque()
             : head_(nullptr), tail_(nullptr), size_(0) {}
 
     template<typename T>
-    Deque<T>::Deque(std::initializer_list<T> args)
+    IPD_CONSTEXPR Deque<T>::Deque(std::initializer_list<T> args)
             : Deque() {
         for (const auto &arg : args)
             push_back(arg);
     }
 
     template<typename T>
-    Deque<T>::Deque(const Deque &other)
+    IPD_CONSTEXPR Deque<T>::Deque(const Deque &other)
             : Deque() {
         for (node_ *curr = other.head_; curr != nullptr; curr = curr->next) {
+            prefetch_(curr->next);
             push_back(curr->val);
         }
     }
 
     template<typename T>
-    Deque<T> &Deque<T>::operator=(const Deque &other) {
+    IPD_CONSTEXPR Deque<T> &Deque<T>::operator=(const Deque &other) {
+        if (this == &other)
+            return *this;
         clear();
 
         for (node_ *curr = other.head_; curr != nullptr; curr = curr->next) {
+            prefetch_(curr->next);
             push_back(curr->val);
         }
 
@@ -127,37 +276,57 @@ namespace ipd {
     }
 
     template<typename T>
-    bool Deque<T>::empty() const {
+    IPD_CONSTEXPR bool Deque<T>::empty() const {
         return size_ == 0;
     }
 
     template<typename T>
-    size_t Deque<T>::size() const {
+    IPD_CONSTEXPR size_t Deque<T>::size() const {
         return size_;
     }
 
     template<typename T>
-    const T &Deque<T>::front() const {
+    IPD_CONSTEXPR const T &Deque<T>::front() const {
         return head_->val;
     }
 
     template<typename T>
-    T &Deque<T>::front() {
+    IPD_CONSTEXPR T &Deque<T>::front() {
         return head_->val;
     }
 
     template<typename T>
-    const T &Deque<T>::back() const {
+    IPD_CONSTEXPR const T &Deque<T>::back() const {
         return tail_->val;
     }
 
     template<typename T>
-    T &Deque<T>::back() {
+    IPD_CONSTEXPR T &Deque<T>::back() {
         return tail_->val;
     }
 
     template<typename T>
-    void Deque<T>::push_front(const T &value) {
+    IPD_CONSTEXPR typename Deque<T>::iterator Deque<T>::begin() {
+        return iterator(head_, this);
+    }
+
+    template<typename T>
+    IPD_CONSTEXPR typename Deque<T>::const_iterator Deque<T>::begin() const {
+        return const_iterator(head_, this);
+    }
+
+    template<typename T>
+    IPD_CONSTEXPR typename Deque<T>::iterator Deque<T>::end() {
+        return iterator(nullptr, this);
+    }
+
+    template<typename T>
+    IPD_CONSTEXPR typename Deque<T>::const_iterator Deque<T>::end() const {
+        return const_iterator(nullptr, this);
+    }
+
+    template<typename T>
+    IPD_CONSTEXPR void Deque<T>::push_front(const T &value) {
         node_ *newNode = new node_(value);
         if (empty()) {
             head_ = newNode;
@@ -171,7 +340,7 @@ namespace ipd {
     }
 
     template<typename T>
-    void Deque<T>::push_back(const T &value) {
+    IPD_CONSTEXPR void Deque<T>::push_back(const T &value) {
         node_ *newNode = new node_(value);
         if (empty()) {
             head_ = newNode;
@@ -185,9 +354,10 @@ namespace ipd {
     }
 
     template<typename T>
-    void Deque<T>::pop_front() {
+    IPD_CONSTEXPR void Deque<T>::pop_front() {
         if (empty())
             return;
+        node_ *oldHead = head_;
         if (head_ == tail_) {
             head_ = nullptr;
             tail_ = nullptr;
@@ -195,14 +365,16 @@ namespace ipd {
             head_ = head_->next;
             head_->prev = nullptr;
         }
+        delete oldHead;
         size_--;
     }
 
     template<typename T>
-    void Deque<T>::pop_back() {
+    IPD_CONSTEXPR void Deque<T>::pop_back() {
         if (empty())
             return;
 
+        node_ *oldTail = tail_;
         if (head_ == tail_) {
             head_ = nullptr;
             tail_ = nullptr;
@@ -210,19 +382,27 @@ namespace ipd {
             tail_ = tail_->prev;
             tail_->next = nullptr;
         }
+        delete oldTail;
         size_--;
 
     }
 
     template<typename T>
-    void Deque<T>::clear() {
-        while (!empty()) {
-            pop_front();
+    IPD_CONSTEXPR void Deque<T>::clear() {
+        node_ *curr = head_;
+        while (curr != nullptr) {
+            node_ *next = curr->next;
+            prefetch_(next);
+            delete curr;
+            curr = next;
         }
+        head_ = nullptr;
+        tail_ = nullptr;
+        size_ = 0;
     }
 
     template<typename T>
-    void Deque<T>::splice(Deque<T> &that) {
+    IPD_CONSTEXPR void Deque<T>::splice(Deque<T> &that) {
         if(that.empty()){
             return;
         }
@@ -245,7 +425,14 @@ namespace ipd {
     }
 
     template<typename T>
-    Deque<T>::~Deque() {
+    IPD_CONSTEXPR void Deque<T>::swap(Deque<T> &that) noexcept {
+        std::swap(head_, that.head_);
+        std::swap(tail_, that.tail_);
+        std::swap(size_, that.size_);
+    }
+
+    template<typename T>
+    IPD_CONSTEXPR Deque<T>::~Deque() {
         clear();
     }
 }
@@ -0,0 +1,305 @@
+#pragma once
+
+/*
+ * Epoch-based memory reclamation (EBR), after Fraser, "Practical Lock
+ * Freedom" (2004).
+ *
+ * Lock-free structures cannot `delete` a node as soon as they unlink it,
+ * because another thread may have loaded a pointer to it a moment earlier.
+ * Under EBR a thread pins itself with a `Guard` for the duration of each
+ * operation, and unlinked nodes are handed to `retire` instead of being
+ * deleted. The domain keeps a global epoch counter that advances only when
+ * every pinned thread has observed the current value; an object retired in
+ * epoch `e` is freed once the global epoch reaches `e + 2`, at which point
+ * no thread that could have seen it is still pinned.
+ *
+ * Pinning and unpinning are a store each, so readers never block or
+ * wait. Every thread keeps its own list of retired objects and tries to
+ * advance the epoch and free them every `collect_interval` retirements,
+ * which keeps the number of unreclaimed objects bounded as long as pinned
+ * threads keep making progress. A thread that is descheduled while pinned
+ * holds the epoch back, and with it all reclamation, until it runs again.
+ *
+ * There is one process-wide domain, `EpochDomain::instance()`. Its thread
+ * records are never freed; a thread's record (and anything still on its
+ * retire list) is handed to the next thread that starts using the domain.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ipd {
+
+    class EpochDomain {
+    public:
+        // Each thread tries to reclaim after this many retirements.
+        static constexpr size_t collect_interval = 64;
+
+        // Returns the process-wide domain.
+        static EpochDomain &instance();
+
+        EpochDomain(const EpochDomain &) = delete;
+
+        EpochDomain &operator=(const EpochDomain &) = delete;
+
+        // Pins the calling thread for the lifetime of the guard. Pointers
+        // loaded from a shared structure while pinned stay valid until the
+        // guard is destroyed. Guards nest.
+        class Guard {
+        public:
+            explicit Guard(EpochDomain & = EpochDomain::instance());
+
+            Guard(const Guard &) = delete;
+
+            Guard &operator=(const Guard &) = delete;
+
+            ~Guard();
+
+        private:
+            EpochDomain &domain_;
+        };
+
+        // Schedules `p` to be deleted once no pinned thread can still hold
+        // a reference to it. `p` must already be unreachable from the shared
+        // structure.
+        template<typename U>
+        void retire(U *p);
+
+        // Same as above, with an explicit deleter.
+        void retire(void *p, void (*deleter)(void *));
+
+        // Tries to advance the global epoch, then frees whatever the calling
+        // thread (or any thread that has since exited) has retired that is
+        // now safe to free.
+        void collect();
+
+        // Returns the number of retired objects not yet freed, across all
+        // threads.
+        size_t pending() const;
+
+        // Returns the current global epoch.
+        uint64_t epoch() const;
+
+    private:
+        struct retired_ {
+            void *ptr;
+            void (*deleter)(void *);
+            uint64_t epoch;
+        };
+
+        // Per-thread state. `state` is 0 when the thread is not pinned and
+        // `(epoch << 1) | 1` when it is pinned in `epoch`.
+        struct record_ {
+            std::atomic<uint64_t> state{0};
+            std::atomic<bool> in_use{true};
+            record_ *next = nullptr;
+
+            // Only touched by the owning thread:
+            unsigned nesting = 0;
+            size_t since_collect = 0;
+            std::vector<retired_> limbo;
+        };
+
+        // Releases the calling thread's record when the thread exits.
+        struct thread_handle_ {
+            record_ *record = nullptr;
+
+            ~thread_handle_();
+        };
+
+        EpochDomain();
+
+        // Returns the calling thread's record, acquiring one if needed.
+        record_ *local_();
+
+        void pin_();
+
+        void unpin_();
+
+        // Advances the global epoch if every pinned thread has observed it.
+        bool try_advance_();
+
+        // Frees the entries of `rec` retired at least two epochs ago.
+        void reclaim_(record_ *rec);
+
+        template<typename U>
+        static void delete_(void *p) { delete static_cast<U *>(p); }
+
+        // Private member variables:
+        std::atomic<uint64_t> epoch_;
+        std::atomic<record_ *> records_;
+        std::atomic<size_t> pending_;
+    };
+
+    // Reclamation policy for concurrent node structures such as
+    // `ConcurrentDeque`, backed by `EpochDomain::instance()`. A `guard` pins
+    // the thread for a whole operation, so `protect` is a plain load.
+    struct EpochReclaim {
+        class guard {
+        public:
+            template<typename P>
+            P *protect(size_t, const std::atomic<P *> &src) {
+                return src.load(std::memory_order_acquire);
+            }
+
+            void reset(size_t) {}
+
+        private:
+            EpochDomain::Guard pin_;
+        };
+
+        template<typename P>
+        static void retire(P *p) { EpochDomain::instance().retire(p); }
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    inline EpochDomain &EpochDomain::instance() {
+        // Never destroyed, so that thread-exit handlers running during
+        // static destruction can still release their records.
+        static EpochDomain *domain = new EpochDomain;
+        return *domain;
+    }
+
+    inline EpochDomain::EpochDomain()
+            : epoch_(0), records_(nullptr), pending_(0) {}
+
+    inline EpochDomain::Guard::Guard(EpochDomain &domain)
+            : domain_(domain) {
+        domain_.pin_();
+    }
+
+    inline EpochDomain::Guard::~Guard() {
+        domain_.unpin_();
+    }
+
+    template<typename U>
+    void EpochDomain::retire(U *p) {
+        retire(static_cast<void *>(p), &delete_<U>);
+    }
+
+    inline void EpochDomain::retire(void *p, void (*deleter)(void *)) {
+        record_ *rec = local_();
+        uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        rec->limbo.push_back(retired_{p, deleter, e});
+        pending_.fetch_add(1, std::memory_order_relaxed);
+
+        if (++rec->since_collect >= collect_interval) {
+            rec->since_collect = 0;
+            collect();
+        }
+    }
+
+    inline void EpochDomain::collect() {
+        try_advance_();
+        reclaim_(local_());
+
+        // Records abandoned by exited threads have nobody else to reclaim
+        // their retire lists, so borrow them briefly.
+        for (record_ *r = records_.load(std::memory_order_acquire);
+             r != nullptr; r = r->next) {
+            bool expected = false;
+            if (r->in_use.load(std::memory_order_relaxed) ||
+                !r->in_use.compare_exchange_strong(expected, true,
+                                                   std::memory_order_acquire))
+                continue;
+            reclaim_(r);
+            r->in_use.store(false, std::memory_order_release);
+        }
+    }
+
+    inline size_t EpochDomain::pending() const {
+        return pending_.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t EpochDomain::epoch() const {
+        return epoch_.load(std::memory_order_relaxed);
+    }
+
+    inline EpochDomain::thread_handle_::~thread_handle_() {
+        if (record != nullptr)
+            record->in_use.store(false, std::memory_order_release);
+    }
+
+    inline EpochDomain::record_ *EpochDomain::local_() {
+        static thread_local thread_handle_ handle;
+        if (handle.record != nullptr)
+            return handle.record;
+
+        // Reuse a record abandoned by an exited thread, if there is one.
+        for (record_ *r = records_.load(std::memory_order_acquire);
+             r != nullptr; r = r->next) {
+            bool expected = false;
+            if (!r->in_use.load(std::memory_order_relaxed) &&
+                r->in_use.compare_exchange_strong(expected, true,
+                                                  std::memory_order_acquire)) {
+                handle.record = r;
+                return r;
+            }
+        }
+
+        record_ *r = new record_;
+        record_ *head = records_.load(std::memory_order_relaxed);
+        do {
+            r->next = head;
+        } while (!records_.compare_exchange_weak(head, r,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+        handle.record = r;
+        return r;
+    }
+
+    inline void EpochDomain::pin_() {
+        record_ *rec = local_();
+        if (rec->nesting++ != 0)
+            return;
+
+        // Publish the epoch we are pinning, then make sure it is still
+        // current so that we do not hold back an epoch we never saw.
+        uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        for (;;) {
+            rec->state.store((e << 1) | 1, std::memory_order_seq_cst);
+            uint64_t now = epoch_.load(std::memory_order_seq_cst);
+            if (now == e)
+                break;
+            e = now;
+        }
+    }
+
+    inline void EpochDomain::unpin_() {
+        record_ *rec = local_();
+        if (--rec->nesting == 0)
+            rec->state.store(0, std::memory_order_release);
+    }
+
+    inline bool EpochDomain::try_advance_() {
+        uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        for (record_ *r = records_.load(std::memory_order_acquire);
+             r != nullptr; r = r->next) {
+            uint64_t s = r->state.load(std::memory_order_seq_cst);
+            if ((s & 1) != 0 && (s >> 1) != e)
+                return false;
+        }
+        return epoch_.compare_exchange_strong(e, e + 1,
+                                              std::memory_order_seq_cst);
+    }
+
+    inline void EpochDomain::reclaim_(record_ *rec) {
+        // Entries are appended in non-decreasing epoch order, so the safe
+        // ones form a prefix.
+        uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        size_t n = 0;
+        while (n < rec->limbo.size() && rec->limbo[n].epoch + 2 <= e) {
+            rec->limbo[n].deleter(rec->limbo[n].ptr);
+            ++n;
+        }
+        if (n == 0)
+            return;
+        rec->limbo.erase(rec->limbo.begin(), rec->limbo.begin() + n);
+        pending_.fetch_sub(n, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,283 @@
+#pragma once
+
+/*
+ * Hazard-pointer memory reclamation, after Michael, "Hazard Pointers: Safe
+ * Memory Reclamation for Lock-Free Objects" (IEEE TPDS 2004).
+ *
+ * Before dereferencing a pointer loaded from a shared structure, a thread
+ * publishes it in one of its hazard slots and re-checks that the structure
+ * still points there. Unlinked nodes are handed to `retire`; when a
+ * thread's retire list reaches `threshold()` entries it scans every
+ * thread's hazard slots and frees each retired node that nobody has
+ * published.
+ *
+ * Unlike `EpochDomain`, a stalled or descheduled thread protects at most
+ * `slots_per_thread` nodes rather than holding back all reclamation, so
+ * every thread's retire list stays below `threshold()` no matter what
+ * the other threads are doing. The price is a store and a re-load on
+ * every protected pointer.
+ *
+ * There is one process-wide domain, `HazardDomain::instance()`. As with
+ * `EpochDomain`, thread records are never freed and are handed on to the
+ * next thread that needs one.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ipd {
+
+    class HazardDomain {
+    public:
+        // Number of hazard slots each thread has.
+        static constexpr size_t slots_per_thread = 2;
+
+        // Returns the process-wide domain.
+        static HazardDomain &instance();
+
+        HazardDomain(const HazardDomain &) = delete;
+
+        HazardDomain &operator=(const HazardDomain &) = delete;
+
+        // Gives access to the calling thread's hazard slots and clears them
+        // when destroyed. A thread may hold only one guard at a time.
+        class Guard {
+        public:
+            explicit Guard(HazardDomain & = HazardDomain::instance());
+
+            Guard(const Guard &) = delete;
+
+            Guard &operator=(const Guard &) = delete;
+
+            // Loads `src`, publishes the result in hazard slot `slot`, and
+            // retries until `src` still holds the published value. The
+            // returned pointer stays valid until the slot is reset or
+            // reused, or the guard is destroyed.
+            template<typename P>
+            P *protect(size_t slot, const std::atomic<P *> &src);
+
+            // Clears hazard slot `slot`.
+            void reset(size_t slot);
+
+            ~Guard();
+
+        private:
+            std::atomic<void *> *slots_;
+        };
+
+        // Schedules `p` to be deleted once it is not published in any
+        // hazard slot. `p` must already be unreachable from the shared
+        // structure.
+        template<typename U>
+        void retire(U *p);
+
+        // Same as above, with an explicit deleter.
+        void retire(void *p, void (*deleter)(void *));
+
+        // Frees every object retired by the calling thread (or by a thread
+        // that has since exited) that is not currently protected.
+        void collect();
+
+        // Returns the number of retired objects not yet freed, across all
+        // threads.
+        size_t pending() const;
+
+        // Returns the retire-list length at which a thread scans. It grows
+        // with the number of threads, so each scan frees a constant
+        // fraction of what it looks at.
+        size_t threshold() const;
+
+    private:
+        struct retired_ {
+            void *ptr;
+            void (*deleter)(void *);
+        };
+
+        struct record_ {
+            std::atomic<void *> hazards[slots_per_thread] = {};
+            std::atomic<bool> in_use{true};
+            record_ *next = nullptr;
+
+            // Only touched by the owning thread:
+            std::vector<retired_> retired;
+        };
+
+        // Releases the calling thread's record when the thread exits.
+        struct thread_handle_ {
+            record_ *record = nullptr;
+
+            ~thread_handle_();
+        };
+
+        HazardDomain();
+
+        // Returns the calling thread's record, acquiring one if needed.
+        record_ *local_();
+
+        // Frees the entries of `rec` that are not in `hazards`, which must
+        // be sorted.
+        void scan_(record_ *rec, const std::vector<void *> &hazards);
+
+        // Returns every currently published hazard pointer, sorted.
+        std::vector<void *> hazards_() const;
+
+        template<typename U>
+        static void delete_(void *p) { delete static_cast<U *>(p); }
+
+        // Private member variables:
+        std::atomic<record_ *> records_;
+        std::atomic<size_t> record_count_;
+        std::atomic<size_t> pending_;
+    };
+
+    // Reclamation policy for concurrent node structures such as
+    // `ConcurrentDeque`, backed by `HazardDomain::instance()`. Every pointer
+    // that will be dereferenced must go through `protect`.
+    struct HazardReclaim {
+        using guard = HazardDomain::Guard;
+
+        template<typename P>
+        static void retire(P *p) { HazardDomain::instance().retire(p); }
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    inline HazardDomain &HazardDomain::instance() {
+        // Never destroyed, so that thread-exit handlers running during
+        // static destruction can still release their records.
+        static HazardDomain *domain = new HazardDomain;
+        return *domain;
+    }
+
+    inline HazardDomain::HazardDomain()
+            : records_(nullptr), record_count_(0), pending_(0) {}
+
+    inline HazardDomain::Guard::Guard(HazardDomain &domain)
+            : slots_(domain.local_()->hazards) {}
+
+    template<typename P>
+    P *HazardDomain::Guard::protect(size_t slot, const std::atomic<P *> &src) {
+        P *p = src.load(std::memory_order_relaxed);
+        for (;;) {
+            slots_[slot].store(p, std::memory_order_seq_cst);
+            P *again = src.load(std::memory_order_seq_cst);
+            if (again == p)
+                return p;
+            p = again;
+        }
+    }
+
+    inline void HazardDomain::Guard::reset(size_t slot) {
+        slots_[slot].store(nullptr, std::memory_order_release);
+    }
+
+    inline HazardDomain::Guard::~Guard() {
+        for (size_t i = 0; i < slots_per_thread; ++i)
+            reset(i);
+    }
+
+    template<typename U>
+    void HazardDomain::retire(U *p) {
+        retire(static_cast<void *>(p), &delete_<U>);
+    }
+
+    inline void HazardDomain::retire(void *p, void (*deleter)(void *)) {
+        record_ *rec = local_();
+        rec->retired.push_back(retired_{p, deleter});
+        pending_.fetch_add(1, std::memory_order_relaxed);
+
+        if (rec->retired.size() >= threshold())
+            scan_(rec, hazards_());
+    }
+
+    inline void HazardDomain::collect() {
+        std::vector<void *> hazards = hazards_();
+        scan_(local_(), hazards);
+
+        for (record_ *r = records_.load(std::memory_order_acquire);
+             r != nullptr; r = r->next) {
+            bool expected = false;
+            if (r->in_use.load(std::memory_order_relaxed) ||
+                !r->in_use.compare_exchange_strong(expected, true,
+                                                   std::memory_order_acquire))
+                continue;
+            scan_(r, hazards);
+            r->in_use.store(false, std::memory_order_release);
+        }
+    }
+
+    inline size_t HazardDomain::pending() const {
+        return pending_.load(std::memory_order_relaxed);
+    }
+
+    inline size_t HazardDomain::threshold() const {
+        size_t h = slots_per_thread *
+                   record_count_.load(std::memory_order_relaxed);
+        return std::max<size_t>(2 * h, 64);
+    }
+
+    inline HazardDomain::thread_handle_::~thread_handle_() {
+        if (record != nullptr)
+            record->in_use.store(false, std::memory_order_release);
+    }
+
+    inline HazardDomain::record_ *HazardDomain::local_() {
+        static thread_local thread_handle_ handle;
+        if (handle.record != nullptr)
+            return handle.record;
+
+        for (record_ *r = records_.load(std::memory_order_acquire);
+             r != nullptr; r = r->next) {
+            bool expected = false;
+            if (!r->in_use.load(std::memory_order_relaxed) &&
+                r->in_use.compare_exchange_strong(expected, true,
+                                                  std::memory_order_acquire)) {
+                handle.record = r;
+                return r;
+            }
+        }
+
+        record_ *r = new record_;
+        record_ *head = records_.load(std::memory_order_relaxed);
+        do {
+            r->next = head;
+        } while (!records_.compare_exchange_weak(head, r,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+        record_count_.fetch_add(1, std::memory_order_relaxed);
+        handle.record = r;
+        return r;
+    }
+
+    inline std::vector<void *> HazardDomain::hazards_() const {
+        std::vector<void *> result;
+        for (record_ *r = records_.load(std::memory_order_acquire);
+             r != nullptr; r = r->next) {
+            for (size_t i = 0; i < slots_per_thread; ++i) {
+                void *p = r->hazards[i].load(std::memory_order_seq_cst);
+                if (p != nullptr)
+                    result.push_back(p);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    inline void HazardDomain::scan_(record_ *rec,
+                                    const std::vector<void *> &hazards) {
+        size_t kept = 0;
+        for (const retired_ &r : rec->retired) {
+            if (std::binary_search(hazards.begin(), hazards.end(), r.ptr))
+                rec->retired[kept++] = r;
+            else
+                r.deleter(r.ptr);
+        }
+        size_t freed = rec->retired.size() - kept;
+        rec->retired.resize(kept);
+        pending_.fetch_sub(freed, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,557 @@
+#pragma once
+
+/*
+ * A linked deque whose nodes all live in one contiguous, growable array
+ * of slots and are linked by 32-bit slot indices instead of pointers. New
+ * nodes are taken from the array's unused tail in order, so elements
+ * pushed in sequence sit next to each other in memory; popped slots go on
+ * a free stack (threaded through their `next` field) and are reused first.
+ *
+ * When the array fills up it doubles. For trivially copyable `T` the
+ * slots are moved with a single memcpy; otherwise the links are copied
+ * and each live element is move-constructed into its new slot.
+ *
+ * Since the links are indices, the slot array is position-independent,
+ * and for trivially copyable `T` the whole deque can be saved with
+ * `write` (a small header followed by the used part of the array, in one
+ * block) and restored with `read`. The format is the in-memory layout, so
+ * it is only portable between builds with the same `T` layout and byte
+ * order.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ipd {
+
+    template<typename T>
+    class IndexDeque {
+        struct slot_;
+
+    public:
+        template<typename Value, typename Owner>
+        class basic_iterator_;
+
+        // Bidirectional iterators over the elements, front to back.
+        using iterator = basic_iterator_<T, IndexDeque>;
+        using const_iterator = basic_iterator_<const T, const IndexDeque>;
+
+        // The largest number of slots the array can hold.
+        static constexpr size_t max_capacity = std::numeric_limits<uint32_t>::max() - 1;
+
+        // Constructs a new, empty deque.
+        IndexDeque();
+
+        // Constructs a deque with the given elements;
+        IndexDeque(std::initializer_list<T>);
+
+        // Copy constructor. The copy's slots are compacted in element order.
+        IndexDeque(const IndexDeque &);
+
+        // Copy-assignment operator.
+        IndexDeque &operator=(const IndexDeque &);
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns the number of slots in the array.
+        size_t capacity() const;
+
+        // Makes room for at least `n` elements without further growth.
+        void reserve(size_t n);
+
+        // Returns a reference to the first element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &front() const;
+
+        T &front();
+
+        // Returns a reference to the last element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &back() const;
+
+        T &back();
+
+        // Returns an iterator to the first element.
+        iterator begin();
+
+        const_iterator begin() const;
+
+        // Returns an iterator one past the last element.
+        iterator end();
+
+        const_iterator end() const;
+
+        // Inserts a new element at the front of the deque.
+        void push_front(const T &);
+
+        // Inserts a new element at the back of the deque.
+        void push_back(const T &);
+
+        // Removes the first element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_front();
+
+        // Removes the last element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_back();
+
+        // Removes all elements from the deque. Keeps the slot array.
+        void clear();
+
+        // Moves all of `that`'s elements to the back of this deque, leaving
+        // `that` empty.
+        void splice(IndexDeque &that);
+
+        // Writes the deque to `out`. Requires trivially copyable T. Returns
+        // false if the stream failed.
+        bool write(std::ostream &out) const;
+
+        // Replaces the contents of the deque with one saved by `write`.
+        // Requires trivially copyable T. Returns false, leaving the deque
+        // empty, if the stream failed or did not hold a valid deque.
+        bool read(std::istream &in);
+
+        // The destructor.
+        ~IndexDeque();
+
+        template<typename Value, typename Owner>
+        class basic_iterator_ {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value *;
+            using reference = Value &;
+
+            basic_iterator_() : owner_(nullptr), curr_(npos_) {}
+
+            // Converts an iterator to a const_iterator.
+            basic_iterator_(const basic_iterator_<T, IndexDeque> &other)
+                    : owner_(other.owner_), curr_(other.curr_) {}
+
+            reference operator*() const { return owner_->slots_[curr_].val(); }
+
+            pointer operator->() const { return &**this; }
+
+            basic_iterator_ &operator++() {
+                curr_ = owner_->slots_[curr_].next;
+                return *this;
+            }
+
+            basic_iterator_ operator++(int) {
+                basic_iterator_ result(*this);
+                ++*this;
+                return result;
+            }
+
+            basic_iterator_ &operator--() {
+                curr_ = curr_ == npos_ ? owner_->tail_ : owner_->slots_[curr_].prev;
+                return *this;
+            }
+
+            basic_iterator_ operator--(int) {
+                basic_iterator_ result(*this);
+                --*this;
+                return result;
+            }
+
+            bool operator==(const basic_iterator_ &other) const {
+                return curr_ == other.curr_;
+            }
+
+            bool operator!=(const basic_iterator_ &other) const {
+                return curr_ != other.curr_;
+            }
+
+        private:
+            friend class IndexDeque;
+
+            template<typename, typename>
+            friend class basic_iterator_;
+
+            basic_iterator_(Owner *owner, uint32_t curr) : owner_(owner), curr_(curr) {}
+
+            Owner *owner_;
+            uint32_t curr_;
+        };
+
+    private:
+        // The null index.
+        static constexpr uint32_t npos_ = std::numeric_limits<uint32_t>::max();
+
+        // A slot holds the links and storage for one element. A free slot
+        // uses `next` as the free-stack link.
+        struct slot_ {
+            uint32_t prev;
+            uint32_t next;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+            T &val() { return *reinterpret_cast<T *>(&storage); }
+
+            const T &val() const { return *reinterpret_cast<const T *>(&storage); }
+        };
+
+        // The header that `write` puts in front of the slots.
+        struct header_ {
+            uint64_t magic;
+            uint64_t slot_size;
+            uint32_t size;
+            uint32_t used;
+            uint32_t head;
+            uint32_t tail;
+            uint32_t free_top;
+            uint32_t reserved;
+        };
+
+        static constexpr uint64_t magic_ = 0x7165647865646e69ULL;  // "indexdeq"
+
+        // Returns an unused slot index, growing the array if needed.
+        uint32_t alloc_();
+
+        // Pushes slot `i`, whose element has been destroyed, on the free stack.
+        void free_(uint32_t i);
+
+        // Reallocates the array with `n` slots.
+        void grow_(size_t n);
+
+        // Destroys the elements and frees the array.
+        void release_();
+
+        // Private member variables. Slots [0, used_) have been handed out
+        // at least once; the rest have never been touched.
+        slot_ *slots_;
+        size_t capacity_;
+        uint32_t used_;
+        uint32_t head_;
+        uint32_t tail_;
+        uint32_t free_top_;
+        size_t size_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T>
+    IndexDeque<T>::IndexDeque()
+            : slots_(nullptr), capacity_(0), used_(0),
+              head_(npos_), tail_(npos_), free_top_(npos_), size_(0) {}
+
+    template<typename T>
+    IndexDeque<T>::IndexDeque(std::initializer_list<T> args)
+            : IndexDeque() {
+        reserve(args.size());
+        for (const auto &arg : args)
+            push_back(arg);
+    }
+
+    template<typename T>
+    IndexDeque<T>::IndexDeque(const IndexDeque &other)
+            : IndexDeque() {
+        reserve(other.size_);
+        for (const T &value : other)
+            push_back(value);
+    }
+
+    template<typename T>
+    IndexDeque<T> &IndexDeque<T>::operator=(const IndexDeque &other) {
+        if (this == &other)
+            return *this;
+        clear();
+        reserve(other.size_);
+        for (const T &value : other)
+            push_back(value);
+        return *this;
+    }
+
+    template<typename T>
+    bool IndexDeque<T>::empty() const {
+        return size_ == 0;
+    }
+
+    template<typename T>
+    size_t IndexDeque<T>::size() const {
+        return size_;
+    }
+
+    template<typename T>
+    size_t IndexDeque<T>::capacity() const {
+        return capacity_;
+    }
+
+    template<typename T>
+    void IndexDeque<T>::reserve(size_t n) {
+        if (n > capacity_)
+            grow_(n);
+    }
+
+    template<typename T>
+    const T &IndexDeque<T>::front() const {
+        return slots_[head_].val();
+    }
+
+    template<typename T>
+    T &IndexDeque<T>::front() {
+        return slots_[head_].val();
+    }
+
+    template<typename T>
+    const T &IndexDeque<T>::back() const {
+        return slots_[tail_].val();
+    }
+
+    template<typename T>
+    T &IndexDeque<T>::back() {
+        return slots_[tail_].val();
+    }
+
+    template<typename T>
+    typename IndexDeque<T>::iterator IndexDeque<T>::begin() {
+        return iterator(this, head_);
+    }
+
+    template<typename T>
+    typename IndexDeque<T>::const_iterator IndexDeque<T>::begin() const {
+        return const_iterator(this, head_);
+    }
+
+    template<typename T>
+    typename IndexDeque<T>::iterator IndexDeque<T>::end() {
+        return iterator(this, npos_);
+    }
+
+    template<typename T>
+    typename IndexDeque<T>::const_iterator IndexDeque<T>::end() const {
+        return const_iterator(this, npos_);
+    }
+
+    template<typename T>
+    void IndexDeque<T>::push_front(const T &value) {
+        uint32_t i = alloc_();
+        ::new(static_cast<void *>(&slots_[i].storage)) T(value);
+        slots_[i].prev = npos_;
+        slots_[i].next = head_;
+        if (empty())
+            tail_ = i;
+        else
+            slots_[head_].prev = i;
+        head_ = i;
+        size_++;
+    }
+
+    template<typename T>
+    void IndexDeque<T>::push_back(const T &value) {
+        uint32_t i = alloc_();
+        ::new(static_cast<void *>(&slots_[i].storage)) T(value);
+        slots_[i].prev = tail_;
+        slots_[i].next = npos_;
+        if (empty())
+            head_ = i;
+        else
+            slots_[tail_].next = i;
+        tail_ = i;
+        size_++;
+    }
+
+    template<typename T>
+    void IndexDeque<T>::pop_front() {
+        if (empty())
+            return;
+        uint32_t oldHead = head_;
+        head_ = slots_[oldHead].next;
+        if (head_ == npos_)
+            tail_ = npos_;
+        else
+            slots_[head_].prev = npos_;
+        slots_[oldHead].val().~T();
+        free_(oldHead);
+        size_--;
+    }
+
+    template<typename T>
+    void IndexDeque<T>::pop_back() {
+        if (empty())
+            return;
+        uint32_t oldTail = tail_;
+        tail_ = slots_[oldTail].prev;
+        if (tail_ == npos_)
+            head_ = npos_;
+        else
+            slots_[tail_].next = npos_;
+        slots_[oldTail].val().~T();
+        free_(oldTail);
+        size_--;
+    }
+
+    template<typename T>
+    void IndexDeque<T>::clear() {
+        if (!std::is_trivially_destructible<T>::value) {
+            for (T &value : *this)
+                value.~T();
+        }
+        // With every slot free again, start handing them out in order.
+        used_ = 0;
+        head_ = npos_;
+        tail_ = npos_;
+        free_top_ = npos_;
+        size_ = 0;
+    }
+
+    template<typename T>
+    void IndexDeque<T>::splice(IndexDeque &that) {
+        if (this == &that)
+            return;
+        reserve(size_ + that.size_);
+        for (const T &value : that)
+            push_back(value);
+        that.clear();
+    }
+
+    template<typename T>
+    bool IndexDeque<T>::write(std::ostream &out) const {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "IndexDeque::write requires a trivially copyable T");
+        header_ h = {magic_, sizeof(slot_), uint32_t(size_), used_,
+                     head_, tail_, free_top_, 0};
+        out.write(reinterpret_cast<const char *>(&h), sizeof h);
+        out.write(reinterpret_cast<const char *>(slots_),
+                  std::streamsize(used_ * sizeof(slot_)));
+        return bool(out);
+    }
+
+    template<typename T>
+    bool IndexDeque<T>::read(std::istream &in) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "IndexDeque::read requires a trivially copyable T");
+        clear();
+
+        header_ h;
+        if (!in.read(reinterpret_cast<char *>(&h), sizeof h))
+            return false;
+        if (h.magic != magic_ || h.slot_size != sizeof(slot_) || h.size > h.used)
+            return false;
+        auto valid = [&](uint32_t i) { return i == npos_ || i < h.used; };
+        if (!valid(h.head) || !valid(h.tail) || !valid(h.free_top) ||
+            (h.size == 0) != (h.head == npos_))
+            return false;
+
+        if (h.used > max_capacity)
+            return false;
+
+        // Read the slots in pieces no larger than what has arrived so far,
+        // so that a header claiming more slots than the stream holds ends
+        // in a short read rather than a huge allocation. `used_` tracks the
+        // slots read, so that growing keeps them.
+        while (used_ < h.used) {
+            uint32_t step = used_ < 1024 ? 1024 : used_;
+            uint32_t n = h.used - used_ < step ? h.used - used_ : step;
+            reserve(size_t(used_) + n);
+            if (!in.read(reinterpret_cast<char *>(slots_ + used_),
+                         std::streamsize(n * sizeof(slot_)))) {
+                used_ = 0;
+                return false;
+            }
+            used_ += n;
+        }
+        used_ = 0;
+
+        // Check that the links form a list of exactly `size` elements, and
+        // that the free list is disjoint from it, so that a corrupt file
+        // cannot send later operations out of bounds or hand out a live
+        // slot.
+        std::vector<bool> live(h.used);
+        uint32_t count = 0, prev = npos_;
+        for (uint32_t i = h.head; i != npos_; prev = i, i = slots_[i].next) {
+            if (!valid(i) || slots_[i].prev != prev || ++count > h.size)
+                return false;
+            live[i] = true;
+        }
+        if (count != h.size || prev != h.tail)
+            return false;
+        for (uint32_t i = h.free_top, n = 0; i != npos_; i = slots_[i].next) {
+            if (!valid(i) || live[i] || ++n > h.used - h.size)
+                return false;
+        }
+
+        used_ = h.used;
+        head_ = h.head;
+        tail_ = h.tail;
+        free_top_ = h.free_top;
+        size_ = h.size;
+        return true;
+    }
+
+    template<typename T>
+    IndexDeque<T>::~IndexDeque() {
+        release_();
+    }
+
+    template<typename T>
+    uint32_t IndexDeque<T>::alloc_() {
+        if (free_top_ != npos_) {
+            uint32_t i = free_top_;
+            free_top_ = slots_[i].next;
+            return i;
+        }
+        if (used_ == capacity_) {
+            if (capacity_ == max_capacity)
+                throw std::length_error("IndexDeque: too many elements");
+            size_t n = capacity_ == 0 ? 8 : 2 * capacity_;
+            grow_(n < max_capacity ? n : size_t(max_capacity));
+        }
+        return used_++;
+    }
+
+    template<typename T>
+    void IndexDeque<T>::free_(uint32_t i) {
+        slots_[i].next = free_top_;
+        free_top_ = i;
+    }
+
+    template<typename T>
+    void IndexDeque<T>::grow_(size_t n) {
+        if (n > max_capacity)
+            throw std::length_error("IndexDeque: too many elements");
+
+        slot_ *grown = static_cast<slot_ *>(::operator new(n * sizeof(slot_)));
+        if (std::is_trivially_copyable<T>::value) {
+            if (used_ != 0)
+                std::memcpy(static_cast<void *>(grown), slots_, used_ * sizeof(slot_));
+        } else {
+            for (uint32_t i = 0; i < used_; ++i) {
+                grown[i].prev = slots_[i].prev;
+                grown[i].next = slots_[i].next;
+            }
+            for (uint32_t i = head_; i != npos_; i = slots_[i].next) {
+                ::new(static_cast<void *>(&grown[i].storage)) T(std::move(slots_[i].val()));
+                slots_[i].val().~T();
+            }
+        }
+        ::operator delete(slots_);
+        slots_ = grown;
+        capacity_ = n;
+    }
+
+    template<typename T>
+    void IndexDeque<T>::release_() {
+        clear();
+        ::operator delete(slots_);
+        slots_ = nullptr;
+        capacity_ = 0;
+    }
+}
@@ -0,0 +1,406 @@
+#pragma once
+
+/*
+ * An intrusive deque: instead of copying elements into nodes it allocates,
+ * it links objects that embed an `IntrusiveHook` member, given as a
+ * pointer-to-member template argument:
+ *
+ *     struct Timer {
+ *         ...
+ *         IntrusiveHook hook;
+ *     };
+ *
+ *     IntrusiveDeque<Timer, &Timer::hook> timers;
+ *
+ * The deque never allocates, copies or destroys elements; it only links
+ * and unlinks them, so an object keeps its identity and the caller keeps
+ * ownership. An object must stay alive while it is linked, and can be in
+ * at most one deque per hook it embeds.
+ *
+ * The list is circular around a sentinel hook inside the deque, so every
+ * operation, including `erase` from the middle, is O(1) and branch-light.
+ *
+ * In safe mode (IPD_INTRUSIVE_SAFE, on by default unless NDEBUG is
+ * defined) unlinked hooks are kept null, and pushing an object that is
+ * already linked, erasing one that is not, or destroying a linked object
+ * fails an assertion.
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#ifndef IPD_INTRUSIVE_SAFE
+#ifdef NDEBUG
+#define IPD_INTRUSIVE_SAFE 0
+#else
+#define IPD_INTRUSIVE_SAFE 1
+#endif
+#endif
+
+namespace ipd {
+
+    // The links that an object embeds to be stored in an `IntrusiveDeque`.
+    // Copying an object does not copy its links: the copy starts unlinked.
+    class IntrusiveHook {
+    public:
+        IntrusiveHook() : prev_(nullptr), next_(nullptr) {}
+
+        IntrusiveHook(const IntrusiveHook &) : IntrusiveHook() {}
+
+        IntrusiveHook &operator=(const IntrusiveHook &) { return *this; }
+
+        // Returns true if the hook is in a deque. Only meaningful in safe
+        // mode, where unlinked hooks are kept null.
+        bool is_linked() const { return next_ != nullptr; }
+
+        ~IntrusiveHook() {
+#if IPD_INTRUSIVE_SAFE
+            assert(!is_linked() && "destroying an object that is still linked");
+#endif
+        }
+
+    private:
+        template<typename T, IntrusiveHook T::*>
+        friend class IntrusiveDeque;
+
+        IntrusiveHook *prev_;
+        IntrusiveHook *next_;
+    };
+
+    template<typename T, IntrusiveHook T::*Hook>
+    class IntrusiveDeque {
+    public:
+        template<typename Value>
+        class basic_iterator_;
+
+        // Bidirectional iterators over the elements, front to back.
+        using iterator = basic_iterator_<T>;
+        using const_iterator = basic_iterator_<const T>;
+
+        // Constructs a new, empty deque.
+        IntrusiveDeque();
+
+        IntrusiveDeque(const IntrusiveDeque &) = delete;
+
+        IntrusiveDeque &operator=(const IntrusiveDeque &) = delete;
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns a reference to the first element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &front() const;
+
+        T &front();
+
+        // Returns a reference to the last element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &back() const;
+
+        T &back();
+
+        // Returns an iterator to the first element.
+        iterator begin();
+
+        const_iterator begin() const;
+
+        // Returns an iterator one past the last element.
+        iterator end();
+
+        const_iterator end() const;
+
+        // Links an object at the front of the deque. The object must not
+        // already be linked through this hook.
+        void push_front(T &);
+
+        // Links an object at the back of the deque. The object must not
+        // already be linked through this hook.
+        void push_back(T &);
+
+        // Unlinks the first element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_front();
+
+        // Unlinks the last element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_back();
+
+        // Unlinks the given object, which must be linked in this deque, from
+        // wherever it is.
+        void erase(T &);
+
+        // Unlinks all elements from the deque.
+        void clear();
+
+        // Moves all of `that`'s elements to the back of this deque in O(1),
+        // leaving `that` empty.
+        void splice(IntrusiveDeque &that);
+
+        // The destructor. Unlinks, but does not destroy, the elements.
+        ~IntrusiveDeque();
+
+        template<typename Value>
+        class basic_iterator_ {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value *;
+            using reference = Value &;
+
+            basic_iterator_() : curr_(nullptr) {}
+
+            // Converts an iterator to a const_iterator.
+            basic_iterator_(const basic_iterator_<T> &other)
+                    : curr_(other.curr_) {}
+
+            reference operator*() const { return *owner_of_(curr_); }
+
+            pointer operator->() const { return owner_of_(curr_); }
+
+            basic_iterator_ &operator++() {
+                curr_ = curr_->next_;
+                return *this;
+            }
+
+            basic_iterator_ operator++(int) {
+                basic_iterator_ result(*this);
+                ++*this;
+                return result;
+            }
+
+            basic_iterator_ &operator--() {
+                curr_ = curr_->prev_;
+                return *this;
+            }
+
+            basic_iterator_ operator--(int) {
+                basic_iterator_ result(*this);
+                --*this;
+                return result;
+            }
+
+            bool operator==(const basic_iterator_ &other) const {
+                return curr_ == other.curr_;
+            }
+
+            bool operator!=(const basic_iterator_ &other) const {
+                return curr_ != other.curr_;
+            }
+
+        private:
+            friend class IntrusiveDeque;
+
+            template<typename>
+            friend class basic_iterator_;
+
+            explicit basic_iterator_(IntrusiveHook *curr) : curr_(curr) {}
+
+            IntrusiveHook *curr_;
+        };
+
+    private:
+        // Returns the offset of the hook within T.
+        static size_t hook_offset_();
+
+        // Maps a hook back to the object that embeds it.
+        static T *owner_of_(IntrusiveHook *);
+
+        static IntrusiveHook &hook_of_(T &obj) { return obj.*Hook; }
+
+        // Links `h` between `prev` and `next`.
+        static void link_(IntrusiveHook *h, IntrusiveHook *prev, IntrusiveHook *next);
+
+        // Unlinks `h` from its neighbours.
+        static void unlink_(IntrusiveHook *h);
+
+        // Private member variables. `sentinel_.next_` is the first element
+        // and `sentinel_.prev_` the last; both point at `sentinel_` when the
+        // deque is empty.
+        IntrusiveHook sentinel_;
+        size_t size_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, IntrusiveHook T::*Hook>
+    IntrusiveDeque<T, Hook>::IntrusiveDeque()
+            : size_(0) {
+        sentinel_.prev_ = &sentinel_;
+        sentinel_.next_ = &sentinel_;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    bool IntrusiveDeque<T, Hook>::empty() const {
+        return size_ == 0;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    size_t IntrusiveDeque<T, Hook>::size() const {
+        return size_;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    const T &IntrusiveDeque<T, Hook>::front() const {
+        return *owner_of_(sentinel_.next_);
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    T &IntrusiveDeque<T, Hook>::front() {
+        return *owner_of_(sentinel_.next_);
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    const T &IntrusiveDeque<T, Hook>::back() const {
+        return *owner_of_(sentinel_.prev_);
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    T &IntrusiveDeque<T, Hook>::back() {
+        return *owner_of_(sentinel_.prev_);
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    typename IntrusiveDeque<T, Hook>::iterator IntrusiveDeque<T, Hook>::begin() {
+        return iterator(sentinel_.next_);
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    typename IntrusiveDeque<T, Hook>::const_iterator
+    IntrusiveDeque<T, Hook>::begin() const {
+        return const_iterator(sentinel_.next_);
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    typename IntrusiveDeque<T, Hook>::iterator IntrusiveDeque<T, Hook>::end() {
+        return iterator(&sentinel_);
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    typename IntrusiveDeque<T, Hook>::const_iterator
+    IntrusiveDeque<T, Hook>::end() const {
+        return const_iterator(const_cast<IntrusiveHook *>(&sentinel_));
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    void IntrusiveDeque<T, Hook>::push_front(T &obj) {
+        link_(&hook_of_(obj), &sentinel_, sentinel_.next_);
+        size_++;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    void IntrusiveDeque<T, Hook>::push_back(T &obj) {
+        link_(&hook_of_(obj), sentinel_.prev_, &sentinel_);
+        size_++;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    void IntrusiveDeque<T, Hook>::pop_front() {
+        if (empty())
+            return;
+        unlink_(sentinel_.next_);
+        size_--;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    void IntrusiveDeque<T, Hook>::pop_back() {
+        if (empty())
+            return;
+        unlink_(sentinel_.prev_);
+        size_--;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    void IntrusiveDeque<T, Hook>::erase(T &obj) {
+        unlink_(&hook_of_(obj));
+        size_--;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    void IntrusiveDeque<T, Hook>::clear() {
+#if IPD_INTRUSIVE_SAFE
+        while (!empty())
+            pop_front();
+#else
+        sentinel_.prev_ = &sentinel_;
+        sentinel_.next_ = &sentinel_;
+        size_ = 0;
+#endif
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    void IntrusiveDeque<T, Hook>::splice(IntrusiveDeque &that) {
+        if (this == &that || that.empty())
+            return;
+
+        IntrusiveHook *first = that.sentinel_.next_;
+        IntrusiveHook *last = that.sentinel_.prev_;
+        first->prev_ = sentinel_.prev_;
+        sentinel_.prev_->next_ = first;
+        last->next_ = &sentinel_;
+        sentinel_.prev_ = last;
+        size_ += that.size_;
+
+        that.sentinel_.prev_ = &that.sentinel_;
+        that.sentinel_.next_ = &that.sentinel_;
+        that.size_ = 0;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    IntrusiveDeque<T, Hook>::~IntrusiveDeque() {
+        clear();
+#if IPD_INTRUSIVE_SAFE
+        sentinel_.prev_ = nullptr;
+        sentinel_.next_ = nullptr;
+#endif
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    size_t IntrusiveDeque<T, Hook>::hook_offset_() {
+        // Measured on suitably aligned raw storage; no T is constructed.
+        static const size_t offset = [] {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+            T *obj = reinterpret_cast<T *>(&storage);
+            return static_cast<size_t>(reinterpret_cast<char *>(&(obj->*Hook)) -
+                                       reinterpret_cast<char *>(obj));
+        }();
+        return offset;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    T *IntrusiveDeque<T, Hook>::owner_of_(IntrusiveHook *h) {
+        return reinterpret_cast<T *>(reinterpret_cast<char *>(h) - hook_offset_());
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    void IntrusiveDeque<T, Hook>::link_(IntrusiveHook *h, IntrusiveHook *prev,
+                                        IntrusiveHook *next) {
+#if IPD_INTRUSIVE_SAFE
+        assert(!h->is_linked() && "object is already linked");
+#endif
+        h->prev_ = prev;
+        h->next_ = next;
+        prev->next_ = h;
+        next->prev_ = h;
+    }
+
+    template<typename T, IntrusiveHook T::*Hook>
+    void IntrusiveDeque<T, Hook>::unlink_(IntrusiveHook *h) {
+#if IPD_INTRUSIVE_SAFE
+        assert(h->is_linked() && "object is not linked");
+#endif
+        h->prev_->next_ = h->next_;
+        h->next_->prev_ = h->prev_;
+#if IPD_INTRUSIVE_SAFE
+        h->prev_ = nullptr;
+        h->next_ = nullptr;
+#endif
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+/*
+ * A monotonic deque for sliding-window extrema. Each pushed value gets a
+ * sequential index; `top` returns the best value among those not yet
+ * expired, where "best" is the one that compares before all others
+ * under `Compare` (the minimum for the default `std::less`, the maximum
+ * with `std::greater`).
+ *
+ * Only candidates that could still become the top are kept: a push first
+ * evicts from the back every value that the new one is at least as good
+ * as, since the new value outlives them. The retained values are
+ * therefore strictly improving from back to front, the front is the top,
+ * and expiring the oldest index only ever pops from the front. Every
+ * value is pushed and popped at most once, so all operations are O(1)
+ * amortized.
+ *
+ * For a sliding window of width w, push each value and then call
+ * `expire(i + 1 - w)` once `i + 1 >= w`.
+ */
+
+#include "Deque.hxx"
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace ipd {
+
+    template<typename T, typename Compare = std::less<T>>
+    class MonotonicDeque {
+    public:
+        // Constructs a new, empty deque.
+        explicit MonotonicDeque(Compare compare = Compare());
+
+        // Returns true if no unexpired value is held.
+        bool empty() const;
+
+        // Returns the number of retained candidates (not the window width).
+        size_t size() const;
+
+        // Returns the index the next pushed value will get.
+        size_t next_index() const;
+
+        // Returns the best unexpired value. Undefined if empty.
+        const T &top() const;
+
+        // Returns the index of the value returned by `top`. Undefined if
+        // empty.
+        size_t top_index() const;
+
+        // Adds a value, evicting every retained value that it is at least as
+        // good as. Returns the new value's index.
+        size_t push(const T &value);
+
+        // Pushes the values in [first, last) as if one by one, but evicts
+        // from the back only once: the batch is first reduced to its own
+        // candidates, and only the best of those is compared against the
+        // retained values. Returns the index of the first value.
+        template<typename ForwardIt>
+        size_t push_n(ForwardIt first, ForwardIt last);
+
+        // Removes the values pushed before `index`.
+        void expire(size_t index);
+
+        // Removes all values. Indices keep counting up.
+        void clear();
+
+    private:
+        struct entry_ {
+            size_t index;
+            T value;
+        };
+
+        // True if `a` is at least as good as `b`, so `a` arriving later
+        // makes `b` useless.
+        bool dominates_(const T &a, const T &b) const {
+            return !compare_(b, a);
+        }
+
+        // Private member variables:
+        Deque<entry_> entries_;
+        size_t next_index_;
+        Compare compare_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, typename Compare>
+    MonotonicDeque<T, Compare>::MonotonicDeque(Compare compare)
+            : next_index_(0), compare_(std::move(compare)) {}
+
+    template<typename T, typename Compare>
+    bool MonotonicDeque<T, Compare>::empty() const {
+        return entries_.empty();
+    }
+
+    template<typename T, typename Compare>
+    size_t MonotonicDeque<T, Compare>::size() const {
+        return entries_.size();
+    }
+
+    template<typename T, typename Compare>
+    size_t MonotonicDeque<T, Compare>::next_index() const {
+        return next_index_;
+    }
+
+    template<typename T, typename Compare>
+    const T &MonotonicDeque<T, Compare>::top() const {
+        return entries_.front().value;
+    }
+
+    template<typename T, typename Compare>
+    size_t MonotonicDeque<T, Compare>::top_index() const {
+        return entries_.front().index;
+    }
+
+    template<typename T, typename Compare>
+    size_t MonotonicDeque<T, Compare>::push(const T &value) {
+        while (!entries_.empty() && dominates_(value, entries_.back().value))
+            entries_.pop_back();
+        entries_.push_back(entry_{next_index_, value});
+        return next_index_++;
+    }
+
+    template<typename T, typename Compare>
+    template<typename ForwardIt>
+    size_t MonotonicDeque<T, Compare>::push_n(ForwardIt first, ForwardIt last) {
+        size_t base = next_index_;
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if (n == 0)
+            return base;
+
+        // Scan the batch back to front, keeping each value that is strictly
+        // better than everything after it: those are the batch's own
+        // candidates, best (earliest) last.
+        std::vector<std::pair<size_t, ForwardIt>> keep;
+        std::vector<ForwardIt> its;
+        its.reserve(n);
+        for (ForwardIt it = first; it != last; ++it)
+            its.push_back(it);
+        for (size_t i = n; i-- > 0;) {
+            if (keep.empty() || !dominates_(*keep.back().second, *its[i]))
+                keep.emplace_back(base + i, its[i]);
+        }
+
+        // Anything the batch's best value dominates is gone.
+        const T &best = *keep.back().second;
+        while (!entries_.empty() && dominates_(best, entries_.back().value))
+            entries_.pop_back();
+
+        for (size_t k = keep.size(); k-- > 0;)
+            entries_.push_back(entry_{keep[k].first, *keep[k].second});
+        next_index_ += n;
+        return base;
+    }
+
+    template<typename T, typename Compare>
+    void MonotonicDeque<T, Compare>::expire(size_t index) {
+        while (!entries_.empty() && entries_.front().index < index)
+            entries_.pop_front();
+    }
+
+    template<typename T, typename Compare>
+    void MonotonicDeque<T, Compare>::clear() {
+        entries_.clear();
+    }
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+/*
+ * An immutable deque with structural sharing. Every "modifying"
+ * operation leaves the deque alone and returns a new version that shares
+ * most of its cells with the old one, so a snapshot is just a copy of the
+ * handle (O(1)), and keeping many versions costs memory only for what
+ * differs between them. Versions are immutable, so they can be read from
+ * any number of threads at once.
+ *
+ * This is Okasaki's banker's deque ("Purely Functional Data Structures",
+ * 1998, section 8.4) over reference-counted cons lists: a front list and
+ * a reversed rear list, kept within a factor of `balance` of each other.
+ * When an operation would break that, the longer list gives half its
+ * cells to the other, which costs O(n) but happens only after O(n) cheap
+ * operations, so push and pop are O(1) amortized.
+ *
+ * The bound is for histories where each version is used once. Okasaki's
+ * persistent bound needs lazy evaluation with memoization; without it,
+ * popping over and over from the same old version that is about to
+ * rebalance pays for the rebalance each time.
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace ipd {
+
+    template<typename T>
+    class PersistentDeque {
+    public:
+        // The lists may differ in length by at most this factor (plus one).
+        static constexpr size_t balance = 3;
+
+        // Constructs a new, empty deque.
+        PersistentDeque();
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns a reference to the first element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &front() const;
+
+        // Returns a reference to the last element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &back() const;
+
+        // Returns a new version with the given element at the front.
+        PersistentDeque push_front(const T &) const;
+
+        // Returns a new version with the given element at the back.
+        PersistentDeque push_back(const T &) const;
+
+        // Returns a new version without the first element. Returns an empty
+        // deque if this one is empty.
+        PersistentDeque pop_front() const;
+
+        // Returns a new version without the last element. Returns an empty
+        // deque if this one is empty.
+        PersistentDeque pop_back() const;
+
+    private:
+        struct cell_;
+        using list_ = std::shared_ptr<cell_>;
+
+        // A cons cell. Cells are never modified once they are reachable
+        // from a published version.
+        struct cell_ {
+            cell_(const T &value, list_ next) : value(value), next(std::move(next)) {}
+
+            // Releases the rest of the list iteratively, so that dropping
+            // the last reference to a long list does not recurse once per
+            // cell and overflow the stack.
+            ~cell_() {
+                list_ rest = std::move(next);
+                while (rest && rest.use_count() == 1)
+                    rest = std::move(rest->next);
+            }
+
+            T value;
+            list_ next;
+        };
+
+        PersistentDeque(list_ front, size_t front_size, list_ rear, size_t rear_size);
+
+        // Builds a version from the given lists, rebalancing if needed.
+        static PersistentDeque make_(list_ front, size_t front_size,
+                                     list_ rear, size_t rear_size);
+
+        // Returns a copy of the first `n` cells of `l`, followed by `tail`.
+        static list_ copy_prefix_(const list_ &l, size_t n, list_ tail);
+
+        // Returns the list after the first `n` cells of `l`.
+        static list_ drop_(list_ l, size_t n);
+
+        // Returns the first `n` cells of `l`, reversed, followed by `tail`.
+        static list_ reverse_onto_(const list_ &l, size_t n, list_ tail);
+
+        // Private member variables. `front_` holds the oldest elements
+        // front first; `rear_` holds the newest, back first.
+        list_ front_;
+        size_t front_size_;
+        list_ rear_;
+        size_t rear_size_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T>
+    PersistentDeque<T>::PersistentDeque()
+            : front_size_(0), rear_size_(0) {}
+
+    template<typename T>
+    PersistentDeque<T>::PersistentDeque(list_ front, size_t front_size,
+                                        list_ rear, size_t rear_size)
+            : front_(std::move(front)), front_size_(front_size),
+              rear_(std::move(rear)), rear_size_(rear_size) {}
+
+    template<typename T>
+    bool PersistentDeque<T>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename T>
+    size_t PersistentDeque<T>::size() const {
+        return front_size_ + rear_size_;
+    }
+
+    template<typename T>
+    const T &PersistentDeque<T>::front() const {
+        // Balance guarantees that an empty front list leaves at most one
+        // element, at the head of the rear list.
+        return front_ ? front_->value : rear_->value;
+    }
+
+    template<typename T>
+    const T &PersistentDeque<T>::back() const {
+        return rear_ ? rear_->value : front_->value;
+    }
+
+    template<typename T>
+    PersistentDeque<T> PersistentDeque<T>::push_front(const T &value) const {
+        return make_(std::make_shared<cell_>(value, front_), front_size_ + 1,
+                     rear_, rear_size_);
+    }
+
+    template<typename T>
+    PersistentDeque<T> PersistentDeque<T>::push_back(const T &value) const {
+        return make_(front_, front_size_,
+                     std::make_shared<cell_>(value, rear_), rear_size_ + 1);
+    }
+
+    template<typename T>
+    PersistentDeque<T> PersistentDeque<T>::pop_front() const {
+        if (!front_)
+            return PersistentDeque();
+        return make_(front_->next, front_size_ - 1, rear_, rear_size_);
+    }
+
+    template<typename T>
+    PersistentDeque<T> PersistentDeque<T>::pop_back() const {
+        if (!rear_)
+            return PersistentDeque();
+        return make_(front_, front_size_, rear_->next, rear_size_ - 1);
+    }
+
+    template<typename T>
+    PersistentDeque<T> PersistentDeque<T>::make_(list_ front, size_t front_size,
+                                                 list_ rear, size_t rear_size) {
+        size_t total = front_size + rear_size;
+        if (front_size > balance * rear_size + 1) {
+            // Keep the first half of the front list; the rest, reversed,
+            // goes after the rear list.
+            size_t keep = total / 2;
+            list_ moved = reverse_onto_(drop_(front, keep), front_size - keep, nullptr);
+            return PersistentDeque(copy_prefix_(front, keep, nullptr), keep,
+                                   copy_prefix_(rear, rear_size, std::move(moved)),
+                                   total - keep);
+        }
+        if (rear_size > balance * front_size + 1) {
+            size_t keep = total / 2;
+            list_ moved = reverse_onto_(drop_(rear, keep), rear_size - keep, nullptr);
+            return PersistentDeque(copy_prefix_(front, front_size, std::move(moved)),
+                                   total - keep,
+                                   copy_prefix_(rear, keep, nullptr), keep);
+        }
+        return PersistentDeque(std::move(front), front_size,
+                               std::move(rear), rear_size);
+    }
+
+    template<typename T>
+    typename PersistentDeque<T>::list_
+    PersistentDeque<T>::copy_prefix_(const list_ &l, size_t n, list_ tail) {
+        if (n == 0)
+            return tail;
+        // Build front to back, filling in each cell's `next` before the
+        // list is published.
+        list_ head = std::make_shared<cell_>(l->value, nullptr);
+        cell_ *last = head.get();
+        const cell_ *src = l->next.get();
+        for (size_t i = 1; i < n; ++i, src = src->next.get()) {
+            last->next = std::make_shared<cell_>(src->value, nullptr);
+            last = last->next.get();
+        }
+        last->next = std::move(tail);
+        return head;
+    }
+
+    template<typename T>
+    typename PersistentDeque<T>::list_
+    PersistentDeque<T>::drop_(list_ l, size_t n) {
+        for (; n > 0; --n)
+            l = l->next;
+        return l;
+    }
+
+    template<typename T>
+    typename PersistentDeque<T>::list_
+    PersistentDeque<T>::reverse_onto_(const list_ &l, size_t n, list_ tail) {
+        const cell_ *src = l.get();
+        for (; n > 0; --n, src = src->next.get()) {
+            assert(src != nullptr);
+            tail = std::make_shared<cell_>(src->value, std::move(tail));
+        }
+        return tail;
+    }
+}
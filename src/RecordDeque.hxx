@@ -0,0 +1,297 @@
+#pragma once
+
+/*
+ * A deque of variable-length byte records (short strings, serialized
+ * messages) packed back to back in large arena blocks, so that queueing a
+ * record costs a copy of its bytes and no allocation of its own, where a
+ * `Deque<std::string>` pays for a node and usually a string buffer too.
+ *
+ * Each record is stored as its length, its bytes, and its length again:
+ * the leading length lets `front` and `pop_front` find the end of the
+ * first record, and the trailing one lets `back` and `pop_back` find the
+ * start of the last. Blocks are chained in a `Deque` of block pointers.
+ * Pushes at the back fill a block upwards from its start and pushes at
+ * the front fill it downwards from its end, so both ends append in place;
+ * a block is freed once its last record is popped, except that one empty
+ * block is kept in reserve so a deque that hovers around a block boundary
+ * does not allocate on every crossing. A record too large for a block
+ * gets a block of its own.
+ *
+ * The views returned by `front` and `back` stay valid until that record
+ * is popped or the deque is cleared or destroyed.
+ *
+ * Requires C++17, for `std::string_view`.
+ */
+
+#include "Deque.hxx"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+
+namespace ipd {
+
+    class RecordDeque {
+    public:
+        // The default number of record bytes per arena block.
+        enum : size_t { default_block_size = 4096 };
+
+        // Constructs a new, empty deque whose blocks hold `block_size` bytes
+        // of records (each record also takes 8 bytes of framing).
+        explicit RecordDeque(size_t block_size = default_block_size);
+
+        RecordDeque(const RecordDeque &) = delete;
+
+        RecordDeque &operator=(const RecordDeque &) = delete;
+
+        // Move constructor. Takes over `other`'s blocks in O(1); `other` is
+        // left empty.
+        RecordDeque(RecordDeque &&other) noexcept;
+
+        // Move-assignment operator. `other` is left empty.
+        RecordDeque &operator=(RecordDeque &&other) noexcept;
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of records in the deque.
+        size_t size() const;
+
+        // Returns the first record. If the deque is empty then the behavior
+        // is undefined.
+        std::string_view front() const;
+
+        // Returns the last record. If the deque is empty then the behavior
+        // is undefined.
+        std::string_view back() const;
+
+        // Inserts a copy of the given bytes as a new record at the front of
+        // the deque. Records must be shorter than 4 GiB.
+        void push_front(std::string_view);
+
+        // Inserts a copy of the given bytes as a new record at the back of
+        // the deque. Records must be shorter than 4 GiB.
+        void push_back(std::string_view);
+
+        // Removes the first record of the deque. Does nothing if the deque
+        // is empty.
+        void pop_front();
+
+        // Removes the last record of the deque. Does nothing if the deque
+        // is empty.
+        void pop_back();
+
+        // Removes all records from the deque.
+        void clear();
+
+        // Calls `f` on each record, front to back.
+        template<typename F>
+        void for_each(F f) const;
+
+        // The destructor.
+        ~RecordDeque();
+
+    private:
+        using length_ = uint32_t;
+
+        enum : size_t { framing_ = 2 * sizeof(length_) };
+
+        // A block header, followed in the same allocation by `capacity`
+        // bytes. The records occupy [begin, end).
+        struct block_ {
+            size_t capacity;
+            size_t begin;
+            size_t end;
+
+            char *data() { return reinterpret_cast<char *>(this + 1); }
+
+            const char *data() const { return reinterpret_cast<const char *>(this + 1); }
+        };
+
+        static length_ load_length_(const char *p) {
+            length_ n;
+            std::memcpy(&n, p, sizeof n);
+            return n;
+        }
+
+        // Writes a framed record into [at, at + framing_ + bytes.size()).
+        static void store_(char *at, std::string_view bytes);
+
+        // Returns an empty block with room for `need` bytes, reusing the
+        // spare if it is big enough.
+        block_ *acquire_(size_t need);
+
+        // Frees a block, or keeps it as the spare.
+        void release_(block_ *);
+
+        static void free_(block_ *);
+
+        // Private member variables:
+        Deque<block_ *> blocks_;
+        block_ *spare_;
+        size_t block_size_;
+        size_t size_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    inline RecordDeque::RecordDeque(size_t block_size)
+            : spare_(nullptr), block_size_(block_size < framing_ ? framing_ : block_size),
+              size_(0) {}
+
+    inline RecordDeque::RecordDeque(RecordDeque &&other) noexcept
+            : spare_(other.spare_), block_size_(other.block_size_), size_(other.size_) {
+        blocks_.swap(other.blocks_);
+        other.spare_ = nullptr;
+        other.size_ = 0;
+    }
+
+    inline RecordDeque &RecordDeque::operator=(RecordDeque &&other) noexcept {
+        if (this != &other) {
+            clear();
+            free_(spare_);
+            blocks_.swap(other.blocks_);
+            spare_ = other.spare_;
+            block_size_ = other.block_size_;
+            size_ = other.size_;
+            other.spare_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    inline bool RecordDeque::empty() const {
+        return size_ == 0;
+    }
+
+    inline size_t RecordDeque::size() const {
+        return size_;
+    }
+
+    inline std::string_view RecordDeque::front() const {
+        const block_ *b = blocks_.front();
+        const char *p = b->data() + b->begin;
+        return std::string_view(p + sizeof(length_), load_length_(p));
+    }
+
+    inline std::string_view RecordDeque::back() const {
+        const block_ *b = blocks_.back();
+        const char *p = b->data() + b->end - sizeof(length_);
+        length_ n = load_length_(p);
+        return std::string_view(p - n, n);
+    }
+
+    inline void RecordDeque::push_front(std::string_view bytes) {
+        size_t need = framing_ + bytes.size();
+        if (empty() || blocks_.front()->begin < need) {
+            block_ *b = acquire_(need);
+            b->begin = b->end = b->capacity;
+            blocks_.push_front(b);
+        }
+        block_ *b = blocks_.front();
+        b->begin -= need;
+        store_(b->data() + b->begin, bytes);
+        size_++;
+    }
+
+    inline void RecordDeque::push_back(std::string_view bytes) {
+        size_t need = framing_ + bytes.size();
+        if (empty() || blocks_.back()->capacity - blocks_.back()->end < need) {
+            block_ *b = acquire_(need);
+            b->begin = b->end = 0;
+            blocks_.push_back(b);
+        }
+        block_ *b = blocks_.back();
+        store_(b->data() + b->end, bytes);
+        b->end += need;
+        size_++;
+    }
+
+    inline void RecordDeque::pop_front() {
+        if (empty())
+            return;
+        block_ *b = blocks_.front();
+        b->begin += framing_ + load_length_(b->data() + b->begin);
+        if (b->begin == b->end) {
+            blocks_.pop_front();
+            release_(b);
+        }
+        size_--;
+    }
+
+    inline void RecordDeque::pop_back() {
+        if (empty())
+            return;
+        block_ *b = blocks_.back();
+        b->end -= framing_ + load_length_(b->data() + b->end - sizeof(length_));
+        if (b->begin == b->end) {
+            blocks_.pop_back();
+            release_(b);
+        }
+        size_--;
+    }
+
+    inline void RecordDeque::clear() {
+        while (!blocks_.empty()) {
+            release_(blocks_.front());
+            blocks_.pop_front();
+        }
+        size_ = 0;
+    }
+
+    template<typename F>
+    void RecordDeque::for_each(F f) const {
+        for (const block_ *b : blocks_) {
+            const char *p = b->data() + b->begin;
+            const char *end = b->data() + b->end;
+            while (p != end) {
+                length_ n = load_length_(p);
+                f(std::string_view(p + sizeof(length_), n));
+                p += framing_ + n;
+            }
+        }
+    }
+
+    inline RecordDeque::~RecordDeque() {
+        clear();
+        free_(spare_);
+    }
+
+    inline void RecordDeque::store_(char *at, std::string_view bytes) {
+        assert(bytes.size() <= length_(-1));
+        length_ n = length_(bytes.size());
+        std::memcpy(at, &n, sizeof n);
+        if (n > 0)
+            std::memcpy(at + sizeof n, bytes.data(), n);
+        std::memcpy(at + sizeof n + n, &n, sizeof n);
+    }
+
+    inline RecordDeque::block_ *RecordDeque::acquire_(size_t need) {
+        if (spare_ && spare_->capacity >= need) {
+            block_ *b = spare_;
+            spare_ = nullptr;
+            return b;
+        }
+        size_t capacity = need > block_size_ ? need : block_size_;
+        void *mem = ::operator new(sizeof(block_) + capacity);
+        return ::new(mem) block_{capacity, 0, 0};
+    }
+
+    inline void RecordDeque::release_(block_ *b) {
+        // Keep only regular-sized blocks; an oversized one was for a single
+        // large record.
+        if (!spare_ && b->capacity == block_size_)
+            spare_ = b;
+        else
+            free_(b);
+    }
+
+    inline void RecordDeque::free_(block_ *b) {
+        ::operator delete(static_cast<void *>(b));
+    }
+}
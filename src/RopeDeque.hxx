@@ -0,0 +1,558 @@
+#pragma once
+
+/*
+ * A deque for sequences that are concatenated, sliced and indexed as
+ * often as they are pushed and popped. Elements live in chunks of at most
+ * `C` elements, held in an AVL tree whose nodes record the number of
+ * elements in their subtree, so `concat`, `split_at` and `operator[]` are
+ * O(log n) instead of O(n) as with `Deque`.
+ *
+ * Each end has a buffer of up to `C` elements. Pushes go into the buffer,
+ * and when it fills, its inner half is added to the tree as one chunk;
+ * pops take from the buffer, refilling it from the first or last chunk of
+ * the tree when it is empty, or, with an empty tree, by taking half of the
+ * other end's buffer. Either way a buffer is left about half full, so it
+ * takes on the order of `C / 2` more operations at that end before the
+ * next refill or flush, and end operations are O(1) amortized even when
+ * pushes and pops alternate at the boundary.
+ *
+ * `split_at` can leave chunks shorter than `C`. They are never merged, so
+ * a deque that is sliced very finely and never pushed to again holds more
+ * (smaller) chunks than necessary.
+ */
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ipd {
+
+    template<typename T, size_t C = 64>
+    class RopeDeque {
+        static_assert(C > 0, "RopeDeque chunk size must be positive");
+
+    public:
+        // Constructs a new, empty deque.
+        RopeDeque();
+
+        // Constructs a deque with the given elements;
+        RopeDeque(std::initializer_list<T>);
+
+        // Copy constructor.
+        RopeDeque(const RopeDeque &);
+
+        // Move constructor. `other` is left empty.
+        RopeDeque(RopeDeque &&other) noexcept;
+
+        // Copy-assignment operator.
+        RopeDeque &operator=(const RopeDeque &);
+
+        // Move-assignment operator. `other` is left empty.
+        RopeDeque &operator=(RopeDeque &&other) noexcept;
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns a reference to the first element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &front() const;
+
+        // Returns a reference to the last element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &back() const;
+
+        // Returns a reference to element `i`, counting from the front, in
+        // O(log n). Undefined if `i >= size()`.
+        const T &operator[](size_t i) const;
+
+        T &operator[](size_t i);
+
+        // Inserts a new element at the front of the deque.
+        void push_front(const T &);
+
+        // Inserts a new element at the back of the deque.
+        void push_back(const T &);
+
+        // Removes the first element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_front();
+
+        // Removes the last element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_back();
+
+        // Removes all elements from the deque.
+        void clear();
+
+        // Moves all of `that`'s elements to the back of this deque in
+        // O(log n), leaving `that` empty.
+        void concat(RopeDeque &that);
+
+        // Removes elements [i, size()) from this deque and returns them, in
+        // O(log n). Undefined if `i > size()`.
+        RopeDeque split_at(size_t i);
+
+        // Calls `f` on each element, front to back.
+        template<typename F>
+        void for_each(F f) const;
+
+    private:
+        struct node_;
+        using tree_ = std::unique_ptr<node_>;
+
+        // A tree node owns one non-empty chunk of consecutive elements.
+        struct node_ {
+            explicit node_(std::vector<T> chunk)
+                    : chunk(std::move(chunk)), size(this->chunk.size()), height(1) {}
+
+            std::vector<T> chunk;
+            tree_ left;
+            tree_ right;
+            // Elements in this subtree, and its height.
+            size_t size;
+            int height;
+        };
+
+        static size_t size_of_(const tree_ &t) { return t ? t->size : 0; }
+
+        static int height_of_(const tree_ &t) { return t ? t->height : 0; }
+
+        // Recomputes `t`'s size and height from its children.
+        static void update_(node_ &t);
+
+        static tree_ rotate_left_(tree_ t);
+
+        static tree_ rotate_right_(tree_ t);
+
+        // Restores the AVL balance at `t`, whose children differ in height
+        // by at most 2.
+        static tree_ rebalance_(tree_ t);
+
+        // Returns the tree of `l`, then `k`'s chunk, then `r`.
+        static tree_ join_(tree_ l, tree_ k, tree_ r);
+
+        // Returns the tree of `l` followed by `r`.
+        static tree_ concat_(tree_ l, tree_ r);
+
+        // Removes the first (last) node of `t` into `out`, returning the rest.
+        static tree_ remove_first_(tree_ t, tree_ &out);
+
+        static tree_ remove_last_(tree_ t, tree_ &out);
+
+        // Splits `t` into its first `i` elements and the rest.
+        static void split_(tree_ t, size_t i, tree_ &l, tree_ &r);
+
+        static tree_ clone_(const tree_ &t);
+
+        template<typename F>
+        static void for_each_(const tree_ &t, F &f);
+
+        // Moves the innermost `n` elements of the front (back) buffer into
+        // the tree as a chunk.
+        void flush_front_(size_t n);
+
+        void flush_back_(size_t n);
+
+        // Refills the empty front (back) buffer from the tree, or, if the
+        // tree is empty, with the first (last) half of the other buffer.
+        void refill_front_();
+
+        void refill_back_();
+
+        // Private member variables. `front_` holds the first elements in
+        // reverse order, so that its back is the deque's front.
+        std::vector<T> front_;
+        tree_ root_;
+        std::vector<T> back_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, size_t C>
+    RopeDeque<T, C>::RopeDeque() = default;
+
+    template<typename T, size_t C>
+    RopeDeque<T, C>::RopeDeque(std::initializer_list<T> args)
+            : RopeDeque() {
+        for (const auto &arg : args)
+            push_back(arg);
+    }
+
+    template<typename T, size_t C>
+    RopeDeque<T, C>::RopeDeque(const RopeDeque &other)
+            : front_(other.front_), root_(clone_(other.root_)), back_(other.back_) {}
+
+    template<typename T, size_t C>
+    RopeDeque<T, C>::RopeDeque(RopeDeque &&other) noexcept
+            : front_(std::move(other.front_)), root_(std::move(other.root_)),
+              back_(std::move(other.back_)) {
+        other.clear();
+    }
+
+    template<typename T, size_t C>
+    RopeDeque<T, C> &RopeDeque<T, C>::operator=(const RopeDeque &other) {
+        if (this != &other) {
+            RopeDeque copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    template<typename T, size_t C>
+    RopeDeque<T, C> &RopeDeque<T, C>::operator=(RopeDeque &&other) noexcept {
+        if (this != &other) {
+            front_ = std::move(other.front_);
+            root_ = std::move(other.root_);
+            back_ = std::move(other.back_);
+            other.clear();
+        }
+        return *this;
+    }
+
+    template<typename T, size_t C>
+    bool RopeDeque<T, C>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename T, size_t C>
+    size_t RopeDeque<T, C>::size() const {
+        return front_.size() + size_of_(root_) + back_.size();
+    }
+
+    template<typename T, size_t C>
+    const T &RopeDeque<T, C>::front() const {
+        if (!front_.empty())
+            return front_.back();
+        if (root_) {
+            const node_ *t = root_.get();
+            while (t->left)
+                t = t->left.get();
+            return t->chunk.front();
+        }
+        return back_.front();
+    }
+
+    template<typename T, size_t C>
+    const T &RopeDeque<T, C>::back() const {
+        if (!back_.empty())
+            return back_.back();
+        if (root_) {
+            const node_ *t = root_.get();
+            while (t->right)
+                t = t->right.get();
+            return t->chunk.back();
+        }
+        return front_.front();
+    }
+
+    template<typename T, size_t C>
+    const T &RopeDeque<T, C>::operator[](size_t i) const {
+        return const_cast<RopeDeque &>(*this)[i];
+    }
+
+    template<typename T, size_t C>
+    T &RopeDeque<T, C>::operator[](size_t i) {
+        if (i < front_.size())
+            return front_[front_.size() - 1 - i];
+        i -= front_.size();
+
+        node_ *t = root_.get();
+        while (t != nullptr) {
+            size_t left = size_of_(t->left);
+            if (i < left) {
+                t = t->left.get();
+            } else if (i - left < t->chunk.size()) {
+                return t->chunk[i - left];
+            } else {
+                i -= left + t->chunk.size();
+                t = t->right.get();
+            }
+        }
+        return back_[i];
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::push_front(const T &value) {
+        front_.push_back(value);
+        if (front_.size() == C)
+            flush_front_(C - C / 2);
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::push_back(const T &value) {
+        back_.push_back(value);
+        if (back_.size() == C)
+            flush_back_(C - C / 2);
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::pop_front() {
+        if (front_.empty())
+            refill_front_();
+        if (!front_.empty())
+            front_.pop_back();
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::pop_back() {
+        if (back_.empty())
+            refill_back_();
+        if (!back_.empty())
+            back_.pop_back();
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::clear() {
+        front_.clear();
+        root_.reset();
+        back_.clear();
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::concat(RopeDeque &that) {
+        if (this == &that || that.empty())
+            return;
+        flush_back_(back_.size());
+        that.flush_front_(that.front_.size());
+        root_ = concat_(std::move(root_), std::move(that.root_));
+        back_ = std::move(that.back_);
+        that.clear();
+    }
+
+    template<typename T, size_t C>
+    RopeDeque<T, C> RopeDeque<T, C>::split_at(size_t i) {
+        flush_front_(front_.size());
+        flush_back_(back_.size());
+        RopeDeque rest;
+        tree_ l;
+        split_(std::move(root_), i, l, rest.root_);
+        root_ = std::move(l);
+        return rest;
+    }
+
+    template<typename T, size_t C>
+    template<typename F>
+    void RopeDeque<T, C>::for_each(F f) const {
+        for (auto it = front_.rbegin(); it != front_.rend(); ++it)
+            f(*it);
+        for_each_(root_, f);
+        for (const T &value : back_)
+            f(value);
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::update_(node_ &t) {
+        t.size = size_of_(t.left) + t.chunk.size() + size_of_(t.right);
+        int l = height_of_(t.left), r = height_of_(t.right);
+        t.height = 1 + (l > r ? l : r);
+    }
+
+    template<typename T, size_t C>
+    typename RopeDeque<T, C>::tree_ RopeDeque<T, C>::rotate_left_(tree_ t) {
+        tree_ r = std::move(t->right);
+        t->right = std::move(r->left);
+        update_(*t);
+        r->left = std::move(t);
+        update_(*r);
+        return r;
+    }
+
+    template<typename T, size_t C>
+    typename RopeDeque<T, C>::tree_ RopeDeque<T, C>::rotate_right_(tree_ t) {
+        tree_ l = std::move(t->left);
+        t->left = std::move(l->right);
+        update_(*t);
+        l->right = std::move(t);
+        update_(*l);
+        return l;
+    }
+
+    template<typename T, size_t C>
+    typename RopeDeque<T, C>::tree_ RopeDeque<T, C>::rebalance_(tree_ t) {
+        update_(*t);
+        int balance = height_of_(t->left) - height_of_(t->right);
+        if (balance > 1) {
+            if (height_of_(t->left->left) < height_of_(t->left->right))
+                t->left = rotate_left_(std::move(t->left));
+            return rotate_right_(std::move(t));
+        }
+        if (balance < -1) {
+            if (height_of_(t->right->right) < height_of_(t->right->left))
+                t->right = rotate_right_(std::move(t->right));
+            return rotate_left_(std::move(t));
+        }
+        return t;
+    }
+
+    template<typename T, size_t C>
+    typename RopeDeque<T, C>::tree_
+    RopeDeque<T, C>::join_(tree_ l, tree_ k, tree_ r) {
+        // Descend the taller tree's inner spine until the heights are
+        // within one, hang `k` there, and rebalance on the way back up.
+        if (height_of_(l) > height_of_(r) + 1) {
+            l->right = join_(std::move(l->right), std::move(k), std::move(r));
+            return rebalance_(std::move(l));
+        }
+        if (height_of_(r) > height_of_(l) + 1) {
+            r->left = join_(std::move(l), std::move(k), std::move(r->left));
+            return rebalance_(std::move(r));
+        }
+        k->left = std::move(l);
+        k->right = std::move(r);
+        update_(*k);
+        return k;
+    }
+
+    template<typename T, size_t C>
+    typename RopeDeque<T, C>::tree_
+    RopeDeque<T, C>::concat_(tree_ l, tree_ r) {
+        if (!l)
+            return r;
+        if (!r)
+            return l;
+        tree_ k;
+        r = remove_first_(std::move(r), k);
+        return join_(std::move(l), std::move(k), std::move(r));
+    }
+
+    template<typename T, size_t C>
+    typename RopeDeque<T, C>::tree_
+    RopeDeque<T, C>::remove_first_(tree_ t, tree_ &out) {
+        if (!t->left) {
+            tree_ rest = std::move(t->right);
+            out = std::move(t);
+            return rest;
+        }
+        t->left = remove_first_(std::move(t->left), out);
+        return rebalance_(std::move(t));
+    }
+
+    template<typename T, size_t C>
+    typename RopeDeque<T, C>::tree_
+    RopeDeque<T, C>::remove_last_(tree_ t, tree_ &out) {
+        if (!t->right) {
+            tree_ rest = std::move(t->left);
+            out = std::move(t);
+            return rest;
+        }
+        t->right = remove_last_(std::move(t->right), out);
+        return rebalance_(std::move(t));
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::split_(tree_ t, size_t i, tree_ &l, tree_ &r) {
+        if (!t) {
+            l.reset();
+            r.reset();
+            return;
+        }
+        tree_ left = std::move(t->left);
+        tree_ right = std::move(t->right);
+        size_t left_size = size_of_(left);
+        size_t chunk_size = t->chunk.size();
+
+        if (i <= left_size) {
+            tree_ middle;
+            split_(std::move(left), i, l, middle);
+            r = join_(std::move(middle), std::move(t), std::move(right));
+        } else if (i >= left_size + chunk_size) {
+            tree_ middle;
+            split_(std::move(right), i - left_size - chunk_size, middle, r);
+            l = join_(std::move(left), std::move(t), std::move(middle));
+        } else {
+            // The split falls inside this node's chunk.
+            auto cut = t->chunk.begin() + std::ptrdiff_t(i - left_size);
+            tree_ tail(new node_(std::vector<T>(std::make_move_iterator(cut),
+                                                std::make_move_iterator(t->chunk.end()))));
+            t->chunk.erase(cut, t->chunk.end());
+            l = join_(std::move(left), std::move(t), nullptr);
+            r = join_(nullptr, std::move(tail), std::move(right));
+        }
+    }
+
+    template<typename T, size_t C>
+    typename RopeDeque<T, C>::tree_ RopeDeque<T, C>::clone_(const tree_ &t) {
+        if (!t)
+            return nullptr;
+        tree_ copy(new node_(t->chunk));
+        copy->left = clone_(t->left);
+        copy->right = clone_(t->right);
+        copy->size = t->size;
+        copy->height = t->height;
+        return copy;
+    }
+
+    template<typename T, size_t C>
+    template<typename F>
+    void RopeDeque<T, C>::for_each_(const tree_ &t, F &f) {
+        if (!t)
+            return;
+        for_each_(t->left, f);
+        for (const T &value : t->chunk)
+            f(value);
+        for_each_(t->right, f);
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::flush_front_(size_t n) {
+        if (n == 0)
+            return;
+        // `front_` is reversed, so its innermost elements come first.
+        auto end = front_.begin() + std::ptrdiff_t(n);
+        tree_ chunk(new node_(std::vector<T>(
+                std::make_move_iterator(std::reverse_iterator<decltype(end)>(end)),
+                std::make_move_iterator(front_.rend()))));
+        root_ = join_(nullptr, std::move(chunk), std::move(root_));
+        front_.erase(front_.begin(), end);
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::flush_back_(size_t n) {
+        if (n == 0)
+            return;
+        auto end = back_.begin() + std::ptrdiff_t(n);
+        tree_ chunk(new node_(std::vector<T>(std::make_move_iterator(back_.begin()),
+                                             std::make_move_iterator(end))));
+        root_ = join_(std::move(root_), std::move(chunk), nullptr);
+        back_.erase(back_.begin(), end);
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::refill_front_() {
+        if (root_) {
+            tree_ first;
+            root_ = remove_first_(std::move(root_), first);
+            front_.assign(std::make_move_iterator(first->chunk.rbegin()),
+                          std::make_move_iterator(first->chunk.rend()));
+        } else if (!back_.empty()) {
+            // Take the first half (rounded up) of `back_`, so that neither
+            // buffer is left to be emptied by the very next pop.
+            auto end = back_.begin() + std::ptrdiff_t((back_.size() + 1) / 2);
+            front_.assign(std::make_move_iterator(std::reverse_iterator<decltype(end)>(end)),
+                          std::make_move_iterator(back_.rend()));
+            back_.erase(back_.begin(), end);
+        }
+    }
+
+    template<typename T, size_t C>
+    void RopeDeque<T, C>::refill_back_() {
+        if (root_) {
+            tree_ last;
+            root_ = remove_last_(std::move(root_), last);
+            back_ = std::move(last->chunk);
+        } else if (!front_.empty()) {
+            auto end = front_.begin() + std::ptrdiff_t((front_.size() + 1) / 2);
+            back_.assign(std::make_move_iterator(std::reverse_iterator<decltype(end)>(end)),
+                         std::make_move_iterator(front_.rend()));
+            front_.erase(front_.begin(), end);
+        }
+    }
+}
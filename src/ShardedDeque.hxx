@@ -0,0 +1,172 @@
+#pragma once
+
+/*
+ * A concurrent deque split into independent shards so that many producers
+ * do not all fight over one lock and one cache line. Each shard is a
+ * `Deque` with its own mutex, padded out to its own cache lines. Each
+ * thread gets a small id on first use, which picks its home shard; it
+ * pushes to its home shard and pops from it first, stealing from the
+ * other shards (in order, skipping empty ones without locking them) only
+ * when its home shard is empty.
+ *
+ * Order is FIFO within a shard but only approximately FIFO overall. The
+ * `fairness` knob trades locality for global order: with fairness `k > 0`
+ * every k-th pop from the deque starts at the next shard round-robin
+ * instead of at the popping thread's home, so a busy home shard cannot
+ * starve the others. `k == 1` visits shards strictly round-robin; `k == 0`
+ * always starts at home and never touches the shared pop counter.
+ */
+
+#include "Deque.hxx"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace ipd {
+
+    template<typename T>
+    class ShardedDeque {
+    public:
+        // Constructs a new, empty deque with `shards` shards (at least one;
+        // defaults to the number of hardware threads) and the given
+        // fairness (see above).
+        explicit ShardedDeque(size_t shards = std::thread::hardware_concurrency(),
+                              size_t fairness = 0);
+
+        ShardedDeque(const ShardedDeque &) = delete;
+
+        ShardedDeque &operator=(const ShardedDeque &) = delete;
+
+        // Returns the number of shards.
+        size_t shard_count() const;
+
+        // Returns the total number of elements. Only a snapshot while other
+        // threads are pushing or popping.
+        size_t size() const;
+
+        // Returns true if every shard is empty (same caveat as `size`).
+        bool empty() const;
+
+        // Inserts a new element at the back of the calling thread's home
+        // shard.
+        void push_back(const T &);
+
+        // Removes an element and stores it in the argument: the first element
+        // of the home shard if it has one, otherwise of the first non-empty
+        // shard after it. Returns false if every shard was empty.
+        bool try_pop_front(T &);
+
+        // Returns the shard that the calling thread pushes to.
+        size_t home_shard() const;
+
+    private:
+        static constexpr size_t cache_line_ = 64;
+
+        struct shard_ {
+            std::mutex mutex;
+            Deque<T> items;
+            // Mirrors `items.size()` so that thieves can skip empty shards
+            // without taking the lock.
+            std::atomic<size_t> count{0};
+            char pad[cache_line_];
+        };
+
+        // Pops from shard `i` if it is non-empty.
+        bool try_pop_from_(size_t i, T &);
+
+        // A small per-thread id, assigned on first use.
+        static size_t thread_slot_();
+
+        // Private member variables:
+        std::unique_ptr<shard_[]> shards_;
+        size_t shard_count_;
+        size_t fairness_;
+        // Counts pops when fairness is on; on its own cache line, since
+        // every popping thread writes it.
+        char pad_[cache_line_];
+        std::atomic<size_t> pops_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T>
+    ShardedDeque<T>::ShardedDeque(size_t shards, size_t fairness)
+            : shard_count_(shards == 0 ? 1 : shards), fairness_(fairness), pops_(0) {
+        shards_.reset(new shard_[shard_count_]);
+    }
+
+    template<typename T>
+    size_t ShardedDeque<T>::shard_count() const {
+        return shard_count_;
+    }
+
+    template<typename T>
+    size_t ShardedDeque<T>::size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < shard_count_; ++i)
+            total += shards_[i].count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    template<typename T>
+    bool ShardedDeque<T>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename T>
+    void ShardedDeque<T>::push_back(const T &value) {
+        shard_ &s = shards_[home_shard()];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.items.push_back(value);
+        s.count.store(s.items.size(), std::memory_order_release);
+    }
+
+    template<typename T>
+    bool ShardedDeque<T>::try_pop_front(T &out) {
+        size_t start = home_shard();
+        if (fairness_ != 0) {
+            size_t round = pops_.fetch_add(1, std::memory_order_relaxed);
+            if (round % fairness_ == 0)
+                start = (start + round / fairness_) % shard_count_;
+        }
+
+        for (size_t k = 0; k < shard_count_; ++k) {
+            if (try_pop_from_((start + k) % shard_count_, out))
+                return true;
+        }
+        return false;
+    }
+
+    template<typename T>
+    size_t ShardedDeque<T>::home_shard() const {
+        return thread_slot_() % shard_count_;
+    }
+
+    template<typename T>
+    bool ShardedDeque<T>::try_pop_from_(size_t i, T &out) {
+        shard_ &s = shards_[i];
+        if (s.count.load(std::memory_order_acquire) == 0)
+            return false;
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.items.empty())
+            return false;
+        out = s.items.front();
+        s.items.pop_front();
+        s.count.store(s.items.size(), std::memory_order_release);
+        return true;
+    }
+
+    template<typename T>
+    size_t ShardedDeque<T>::thread_slot_() {
+        static std::atomic<size_t> next_slot(0);
+        static thread_local size_t slot =
+                next_slot.fetch_add(1, std::memory_order_relaxed);
+        return slot;
+    }
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+/*
+ * A deque with a small-buffer optimization: the first K elements live in
+ * an inline `StaticDeque`, and only when a push would overflow it does the
+ * deque move its elements into a heap-allocated `Deque` and carry on
+ * there. When the heap deque empties out, the deque drops it and goes
+ * back to inline storage, so a deque that is usually small allocates
+ * nothing in the steady state.
+ */
+
+#include "Deque.hxx"
+#include "StaticDeque.hxx"
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace ipd {
+
+    template<typename T, size_t K = 8>
+    class SmallDeque {
+    public:
+        // Constructs a new, empty deque.
+        SmallDeque();
+
+        // Constructs a deque with the given elements;
+        SmallDeque(std::initializer_list<T>);
+
+        // Copy constructor.
+        SmallDeque(const SmallDeque &);
+
+        // Move constructor. Steals the heap deque if `other` has spilled,
+        // and moves the inline elements otherwise; `other` is left empty.
+        SmallDeque(SmallDeque &&other) noexcept(
+                std::is_nothrow_move_constructible<T>::value);
+
+        // Copy-assignment operator.
+        SmallDeque &operator=(const SmallDeque &);
+
+        // Move-assignment operator. `other` is left empty.
+        SmallDeque &operator=(SmallDeque &&other) noexcept(
+                std::is_nothrow_move_constructible<T>::value);
+
+        // Returns true if the elements are stored inline (have not spilled
+        // to the heap).
+        bool is_inline() const;
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns a reference to the first element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &front() const;
+
+        T &front();
+
+        // Returns a reference to the last element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &back() const;
+
+        T &back();
+
+        // Inserts a new element at the front of the deque.
+        void push_front(const T &);
+
+        // Inserts a new element at the back of the deque.
+        void push_back(const T &);
+
+        // Removes the first element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_front();
+
+        // Removes the last element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_back();
+
+        // Removes all elements from the deque and returns to inline storage.
+        void clear();
+
+    private:
+        // Moves the inline elements to a new heap deque.
+        void spill_();
+
+        // Returns to inline storage if the heap deque has emptied.
+        void shrink_();
+
+        // Private member variables. Exactly one of the two is in use: `heap_`
+        // when it is non-null, `inline_` otherwise.
+        StaticDeque<T, K> inline_;
+        std::unique_ptr<Deque<T>> heap_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, size_t K>
+    SmallDeque<T, K>::SmallDeque() = default;
+
+    template<typename T, size_t K>
+    SmallDeque<T, K>::SmallDeque(std::initializer_list<T> args)
+            : SmallDeque() {
+        for (const auto &arg : args)
+            push_back(arg);
+    }
+
+    template<typename T, size_t K>
+    SmallDeque<T, K>::SmallDeque(const SmallDeque &other)
+            : inline_(other.inline_),
+              heap_(other.heap_ ? new Deque<T>(*other.heap_) : nullptr) {}
+
+    template<typename T, size_t K>
+    SmallDeque<T, K>::SmallDeque(SmallDeque &&other) noexcept(
+            std::is_nothrow_move_constructible<T>::value)
+            : inline_(std::move(other.inline_)),
+              heap_(std::move(other.heap_)) {}
+
+    template<typename T, size_t K>
+    SmallDeque<T, K> &SmallDeque<T, K>::operator=(const SmallDeque &other) {
+        if (this == &other)
+            return *this;
+        inline_ = other.inline_;
+        if (other.heap_ == nullptr)
+            heap_.reset();
+        else if (heap_ == nullptr)
+            heap_.reset(new Deque<T>(*other.heap_));
+        else
+            *heap_ = *other.heap_;
+        return *this;
+    }
+
+    template<typename T, size_t K>
+    SmallDeque<T, K> &SmallDeque<T, K>::operator=(SmallDeque &&other) noexcept(
+            std::is_nothrow_move_constructible<T>::value) {
+        if (this == &other)
+            return *this;
+        inline_ = std::move(other.inline_);
+        heap_ = std::move(other.heap_);
+        return *this;
+    }
+
+    template<typename T, size_t K>
+    bool SmallDeque<T, K>::is_inline() const {
+        return heap_ == nullptr;
+    }
+
+    template<typename T, size_t K>
+    bool SmallDeque<T, K>::empty() const {
+        return heap_ ? heap_->empty() : inline_.empty();
+    }
+
+    template<typename T, size_t K>
+    size_t SmallDeque<T, K>::size() const {
+        return heap_ ? heap_->size() : inline_.size();
+    }
+
+    template<typename T, size_t K>
+    const T &SmallDeque<T, K>::front() const {
+        return heap_ ? heap_->front() : inline_.front();
+    }
+
+    template<typename T, size_t K>
+    T &SmallDeque<T, K>::front() {
+        return heap_ ? heap_->front() : inline_.front();
+    }
+
+    template<typename T, size_t K>
+    const T &SmallDeque<T, K>::back() const {
+        return heap_ ? heap_->back() : inline_.back();
+    }
+
+    template<typename T, size_t K>
+    T &SmallDeque<T, K>::back() {
+        return heap_ ? heap_->back() : inline_.back();
+    }
+
+    template<typename T, size_t K>
+    void SmallDeque<T, K>::push_front(const T &value) {
+        if (heap_ == nullptr && inline_.try_push_front(value))
+            return;
+        if (heap_ == nullptr)
+            spill_();
+        heap_->push_front(value);
+    }
+
+    template<typename T, size_t K>
+    void SmallDeque<T, K>::push_back(const T &value) {
+        if (heap_ == nullptr && inline_.try_push_back(value))
+            return;
+        if (heap_ == nullptr)
+            spill_();
+        heap_->push_back(value);
+    }
+
+    template<typename T, size_t K>
+    void SmallDeque<T, K>::pop_front() {
+        if (heap_ == nullptr) {
+            inline_.pop_front();
+        } else {
+            heap_->pop_front();
+            shrink_();
+        }
+    }
+
+    template<typename T, size_t K>
+    void SmallDeque<T, K>::pop_back() {
+        if (heap_ == nullptr) {
+            inline_.pop_back();
+        } else {
+            heap_->pop_back();
+            shrink_();
+        }
+    }
+
+    template<typename T, size_t K>
+    void SmallDeque<T, K>::clear() {
+        inline_.clear();
+        heap_.reset();
+    }
+
+    template<typename T, size_t K>
+    void SmallDeque<T, K>::spill_() {
+        std::unique_ptr<Deque<T>> heap(new Deque<T>);
+        for (; !inline_.empty(); inline_.pop_front())
+            heap->push_back(inline_.front());
+        heap_ = std::move(heap);
+    }
+
+    template<typename T, size_t K>
+    void SmallDeque<T, K>::shrink_() {
+        if (heap_->empty())
+            heap_.reset();
+    }
+}
@@ -0,0 +1,515 @@
+#pragma once
+
+/*
+ * A deque for queues that can outgrow memory. Elements are stored in
+ * fixed-size blocks, and only a bounded number of blocks (the memory
+ * budget) stay in memory: the ones at the head and the tail, where pushes
+ * and pops happen. When the budget is exceeded, the resident block
+ * closest to the middle is written with `pwrite` to an anonymous
+ * temporary file and freed; the blocks in between the resident head and
+ * tail all live on disk, in order.
+ *
+ * As an end drains towards the spilled blocks, the next one is read back
+ * with `pread` before the current end block gives up its last element,
+ * so that pops rarely wait for the disk, and the block after that is
+ * announced to the kernel with `posix_fadvise(POSIX_FADV_WILLNEED)` so it
+ * is already in the page cache when its turn comes. File space of blocks
+ * that have been read back is reused by later spills.
+ *
+ * Blocks are copied to and from disk byte for byte, so T must be
+ * trivially copyable. I/O failures throw `std::system_error`, and a push
+ * or pop that throws leaves the deque as it was. The file is created on
+ * the first spill, in `$TMPDIR` (or /tmp) unless a directory is given,
+ * and is unlinked immediately, so it disappears with the process. POSIX
+ * only.
+ */
+
+#include "Deque.hxx"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ipd {
+
+    template<typename T>
+    class SpillDeque {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "SpillDeque elements must be trivially copyable");
+
+    public:
+        // Constructs a new, empty deque that keeps at most `memory_budget`
+        // bytes of blocks in memory (but always at least two blocks, plus
+        // one spare), in blocks of `block_bytes` bytes, spilling to a file
+        // in `dir`.
+        explicit SpillDeque(size_t memory_budget = size_t(64) << 20,
+                            size_t block_bytes = size_t(1) << 16,
+                            std::string dir = std::string());
+
+        SpillDeque(const SpillDeque &) = delete;
+
+        SpillDeque &operator=(const SpillDeque &) = delete;
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns the number of blocks held in memory, and on disk.
+        size_t resident_blocks() const;
+
+        size_t spilled_blocks() const;
+
+        // Returns a reference to the first element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &front() const;
+
+        // Returns a reference to the last element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &back() const;
+
+        // Inserts a new element at the front of the deque.
+        void push_front(const T &);
+
+        // Inserts a new element at the back of the deque.
+        void push_back(const T &);
+
+        // Removes the first element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_front();
+
+        // Removes the last element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_back();
+
+        // Removes all elements from the deque and truncates the file.
+        void clear();
+
+        // The destructor.
+        ~SpillDeque();
+
+    private:
+        using storage_ = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+        // An in-memory block. Its elements occupy slots [begin, end).
+        struct block_ {
+            std::unique_ptr<storage_[]> slots;
+            size_t begin;
+            size_t end;
+
+            T *items() { return reinterpret_cast<T *>(slots.get()); }
+
+            const T *items() const { return reinterpret_cast<const T *>(slots.get()); }
+        };
+
+        // A block on disk, at byte `offset` of the file.
+        struct extent_ {
+            off_t offset;
+            size_t begin;
+            size_t end;
+        };
+
+        // Returns an empty block, reusing the spare if there is one.
+        block_ *acquire_();
+
+        // Frees a block, or keeps it as the spare.
+        void release_(block_ *);
+
+        // Spills blocks nearest the middle until the budget is met.
+        void enforce_budget_();
+
+        // Writes a block to disk and frees it; reads one back.
+        extent_ spill_(block_ *);
+
+        block_ *load_(const extent_ &);
+
+        // Moves the first (last) spilled block back behind the head (in
+        // front of the tail). Throws, with nothing changed, if the read
+        // fails.
+        void load_front_();
+
+        void load_back_();
+
+        // Loads the next spilled block if the pop about to happen would
+        // otherwise empty the head (tail).
+        void load_before_pop_front_();
+
+        void load_before_pop_back_();
+
+        // Brings a second spilled block in behind the head (tail) while the
+        // budget allows, and hints the kernel to read ahead the one after.
+        // A failed read is left for the next pop to report.
+        void refill_front_();
+
+        void refill_back_();
+
+        void will_need_(const extent_ &);
+
+        void open_file_();
+
+        // Private member variables. The deque is `head_`, then `middle_`,
+        // then `tail_`; `middle_` is non-empty only if both ends are.
+        Deque<block_ *> head_;
+        Deque<extent_> middle_;
+        Deque<block_ *> tail_;
+        block_ *spare_;
+        std::vector<off_t> free_offsets_;
+        off_t file_end_;
+        int fd_;
+        size_t per_block_;
+        size_t max_resident_;
+        size_t size_;
+        std::string dir_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T>
+    SpillDeque<T>::SpillDeque(size_t memory_budget, size_t block_bytes, std::string dir)
+            : spare_(nullptr), file_end_(0), fd_(-1),
+              per_block_(block_bytes < sizeof(T) ? 1 : block_bytes / sizeof(T)),
+              size_(0), dir_(std::move(dir)) {
+        size_t blocks = memory_budget / (per_block_ * sizeof(T));
+        max_resident_ = blocks < 2 ? 2 : blocks;
+    }
+
+    template<typename T>
+    bool SpillDeque<T>::empty() const {
+        return size_ == 0;
+    }
+
+    template<typename T>
+    size_t SpillDeque<T>::size() const {
+        return size_;
+    }
+
+    template<typename T>
+    size_t SpillDeque<T>::resident_blocks() const {
+        return head_.size() + tail_.size();
+    }
+
+    template<typename T>
+    size_t SpillDeque<T>::spilled_blocks() const {
+        return middle_.size();
+    }
+
+    template<typename T>
+    const T &SpillDeque<T>::front() const {
+        const block_ *b = head_.empty() ? tail_.front() : head_.front();
+        return b->items()[b->begin];
+    }
+
+    template<typename T>
+    const T &SpillDeque<T>::back() const {
+        const block_ *b = tail_.empty() ? head_.back() : tail_.back();
+        return b->items()[b->end - 1];
+    }
+
+    template<typename T>
+    void SpillDeque<T>::push_front(const T &value) {
+        block_ *b = head_.empty() ? (tail_.empty() ? nullptr : tail_.front()) : head_.front();
+        if (!b || b->begin == 0) {
+            b = acquire_();
+            b->begin = b->end = per_block_;
+            head_.push_front(b);
+            try {
+                enforce_budget_();
+            } catch (...) {
+                // The new block stays at this end whatever was spilled, and
+                // the spills that did succeed kept the order.
+                head_.pop_front();
+                release_(b);
+                throw;
+            }
+        }
+        b->items()[--b->begin] = value;
+        size_++;
+    }
+
+    template<typename T>
+    void SpillDeque<T>::push_back(const T &value) {
+        block_ *b = tail_.empty() ? (head_.empty() ? nullptr : head_.back()) : tail_.back();
+        if (!b || b->end == per_block_) {
+            b = acquire_();
+            b->begin = b->end = 0;
+            tail_.push_back(b);
+            try {
+                enforce_budget_();
+            } catch (...) {
+                // The new block stays at this end whatever was spilled, and
+                // the spills that did succeed kept the order.
+                tail_.pop_back();
+                release_(b);
+                throw;
+            }
+        }
+        b->items()[b->end++] = value;
+        size_++;
+    }
+
+    template<typename T>
+    void SpillDeque<T>::pop_front() {
+        if (empty())
+            return;
+        load_before_pop_front_();
+        Deque<block_ *> &side = head_.empty() ? tail_ : head_;
+        block_ *b = side.front();
+        if (++b->begin == b->end) {
+            side.pop_front();
+            release_(b);
+        }
+        size_--;
+        refill_front_();
+    }
+
+    template<typename T>
+    void SpillDeque<T>::pop_back() {
+        if (empty())
+            return;
+        load_before_pop_back_();
+        Deque<block_ *> &side = tail_.empty() ? head_ : tail_;
+        block_ *b = side.back();
+        if (--b->end == b->begin) {
+            side.pop_back();
+            release_(b);
+        }
+        size_--;
+        refill_back_();
+    }
+
+    template<typename T>
+    void SpillDeque<T>::clear() {
+        while (!head_.empty()) {
+            release_(head_.front());
+            head_.pop_front();
+        }
+        while (!tail_.empty()) {
+            release_(tail_.front());
+            tail_.pop_front();
+        }
+        middle_.clear();
+        free_offsets_.clear();
+        file_end_ = 0;
+        if (fd_ >= 0 && ::ftruncate(fd_, 0) != 0)
+            throw std::system_error(errno, std::generic_category(), "SpillDeque: ftruncate");
+        size_ = 0;
+    }
+
+    template<typename T>
+    SpillDeque<T>::~SpillDeque() {
+        for (block_ *b : head_)
+            delete b;
+        for (block_ *b : tail_)
+            delete b;
+        delete spare_;
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    template<typename T>
+    typename SpillDeque<T>::block_ *SpillDeque<T>::acquire_() {
+        if (spare_) {
+            block_ *b = spare_;
+            spare_ = nullptr;
+            return b;
+        }
+        return new block_{std::unique_ptr<storage_[]>(new storage_[per_block_]), 0, 0};
+    }
+
+    template<typename T>
+    void SpillDeque<T>::release_(block_ *b) {
+        if (spare_)
+            delete b;
+        else
+            spare_ = b;
+    }
+
+    template<typename T>
+    void SpillDeque<T>::enforce_budget_() {
+        while (resident_blocks() > max_resident_) {
+            // Both ends must keep a block while anything is on disk, so
+            // first even out a lopsided deque in memory.
+            if (middle_.empty() && tail_.empty()) {
+                tail_.push_front(head_.back());
+                head_.pop_back();
+            } else if (middle_.empty() && head_.empty()) {
+                head_.push_back(tail_.front());
+                tail_.pop_front();
+            }
+
+            if (tail_.size() >= head_.size() && tail_.size() > 1) {
+                middle_.push_back(spill_(tail_.front()));
+                tail_.pop_front();
+            } else if (head_.size() > 1) {
+                middle_.push_front(spill_(head_.back()));
+                head_.pop_back();
+            } else {
+                break;
+            }
+        }
+    }
+
+    template<typename T>
+    typename SpillDeque<T>::extent_ SpillDeque<T>::spill_(block_ *b) {
+        if (fd_ < 0)
+            open_file_();
+
+        extent_ e{free_offsets_.empty() ? file_end_ : free_offsets_.back(), b->begin, b->end};
+
+        const char *src = reinterpret_cast<const char *>(b->items() + b->begin);
+        size_t len = (b->end - b->begin) * sizeof(T);
+        off_t at = e.offset + off_t(b->begin * sizeof(T));
+        while (len > 0) {
+            ssize_t n = ::pwrite(fd_, src, len, at);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                throw std::system_error(n < 0 ? errno : EIO, std::generic_category(),
+                                        "SpillDeque: pwrite");
+            src += n;
+            len -= size_t(n);
+            at += n;
+        }
+        // Claim the file space only now that the write has succeeded.
+        if (!free_offsets_.empty())
+            free_offsets_.pop_back();
+        else
+            file_end_ += off_t(per_block_ * sizeof(T));
+        release_(b);
+        return e;
+    }
+
+    template<typename T>
+    typename SpillDeque<T>::block_ *SpillDeque<T>::load_(const extent_ &e) {
+        block_ *b = acquire_();
+        b->begin = e.begin;
+        b->end = e.end;
+
+        char *dst = reinterpret_cast<char *>(b->items() + e.begin);
+        size_t len = (e.end - e.begin) * sizeof(T);
+        off_t at = e.offset + off_t(e.begin * sizeof(T));
+        while (len > 0) {
+            ssize_t n = ::pread(fd_, dst, len, at);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                int err = n < 0 ? errno : EIO;
+                release_(b);
+                throw std::system_error(err, std::generic_category(), "SpillDeque: pread");
+            }
+            dst += n;
+            len -= size_t(n);
+            at += n;
+        }
+        return b;
+    }
+
+    template<typename T>
+    void SpillDeque<T>::load_front_() {
+        block_ *b = load_(middle_.front());
+        try {
+            head_.push_back(b);
+        } catch (...) {
+            release_(b);
+            throw;
+        }
+        off_t offset = middle_.front().offset;
+        middle_.pop_front();
+        free_offsets_.push_back(offset);
+    }
+
+    template<typename T>
+    void SpillDeque<T>::load_back_() {
+        block_ *b = load_(middle_.back());
+        try {
+            tail_.push_front(b);
+        } catch (...) {
+            release_(b);
+            throw;
+        }
+        off_t offset = middle_.back().offset;
+        middle_.pop_back();
+        free_offsets_.push_back(offset);
+    }
+
+    template<typename T>
+    void SpillDeque<T>::load_before_pop_front_() {
+        if (middle_.empty() || head_.size() > 1)
+            return;
+        const block_ *b = head_.front();
+        if (b->end - b->begin == 1)
+            load_front_();
+    }
+
+    template<typename T>
+    void SpillDeque<T>::load_before_pop_back_() {
+        if (middle_.empty() || tail_.size() > 1)
+            return;
+        const block_ *b = tail_.back();
+        if (b->end - b->begin == 1)
+            load_back_();
+    }
+
+    template<typename T>
+    void SpillDeque<T>::refill_front_() {
+        // The pop has already happened, so this must not throw.
+        while (!middle_.empty() && head_.size() < 2 && resident_blocks() < max_resident_) {
+            try {
+                load_front_();
+            } catch (...) {
+                break;
+            }
+            if (!middle_.empty())
+                will_need_(middle_.front());
+        }
+    }
+
+    template<typename T>
+    void SpillDeque<T>::refill_back_() {
+        while (!middle_.empty() && tail_.size() < 2 && resident_blocks() < max_resident_) {
+            try {
+                load_back_();
+            } catch (...) {
+                break;
+            }
+            if (!middle_.empty())
+                will_need_(middle_.back());
+        }
+    }
+
+    template<typename T>
+    void SpillDeque<T>::will_need_(const extent_ &e) {
+#ifdef POSIX_FADV_WILLNEED
+        ::posix_fadvise(fd_, e.offset + off_t(e.begin * sizeof(T)),
+                        off_t((e.end - e.begin) * sizeof(T)), POSIX_FADV_WILLNEED);
+#else
+        (void) e;
+#endif
+    }
+
+    template<typename T>
+    void SpillDeque<T>::open_file_() {
+        std::string dir = dir_;
+        if (dir.empty()) {
+            const char *tmp = std::getenv("TMPDIR");
+            dir = tmp && *tmp ? tmp : "/tmp";
+        }
+        std::string path = dir + "/ipd-spill-XXXXXX";
+        fd_ = ::mkstemp(&path[0]);
+        if (fd_ < 0)
+            throw std::system_error(errno, std::generic_category(), "SpillDeque: mkstemp");
+        ::unlink(path.c_str());
+    }
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+/*
+ * A fixed-capacity deque whose elements live inside the object itself, in
+ * a ring buffer of uninitialized storage, so it never touches the heap.
+ * It has the same interface as `Deque`, plus `capacity`, `full` and the
+ * `try_push_*` operations, which report overflow instead of requiring the
+ * caller to check first. When `N` is a power of two, ring indices wrap
+ * with a mask instead of a compare.
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ipd {
+
+    template<typename T, size_t N>
+    class StaticDeque {
+        static_assert(N > 0, "StaticDeque capacity must be positive");
+
+    public:
+        // Constructs a new, empty deque.
+        StaticDeque();
+
+        // Constructs a deque with the given elements, which must number at
+        // most N.
+        StaticDeque(std::initializer_list<T>);
+
+        // Copy constructor.
+        StaticDeque(const StaticDeque &);
+
+        // Move constructor. Moves the elements one by one; `other` is left
+        // empty.
+        StaticDeque(StaticDeque &&other) noexcept(
+                std::is_nothrow_move_constructible<T>::value);
+
+        // Copy-assignment operator.
+        StaticDeque &operator=(const StaticDeque &);
+
+        // Move-assignment operator. `other` is left empty.
+        StaticDeque &operator=(StaticDeque &&other) noexcept(
+                std::is_nothrow_move_constructible<T>::value);
+
+        // Returns the maximum number of elements, N.
+        static constexpr size_t capacity() { return N; }
+
+        // Returns true if the deque is empty.
+        bool empty() const;
+
+        // Returns true if the deque holds N elements.
+        bool full() const;
+
+        // Returns the number of elements in the deque.
+        size_t size() const;
+
+        // Returns a reference to the first element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &front() const;
+
+        T &front();
+
+        // Returns a reference to the last element of the deque. If the deque is
+        // empty then the behavior is undefined.
+        const T &back() const;
+
+        T &back();
+
+        // Inserts a new element at the front of the deque. Undefined if the
+        // deque is full.
+        void push_front(const T &);
+
+        void push_front(T &&);
+
+        // Inserts a new element at the back of the deque. Undefined if the
+        // deque is full.
+        void push_back(const T &);
+
+        void push_back(T &&);
+
+        // Inserts a new element at the front of the deque, unless it is full.
+        // Returns false (and leaves the deque unchanged) if it was full.
+        bool try_push_front(const T &);
+
+        // Inserts a new element at the back of the deque, unless it is full.
+        // Returns false (and leaves the deque unchanged) if it was full.
+        bool try_push_back(const T &);
+
+        // Removes the first element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_front();
+
+        // Removes the last element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_back();
+
+        // Removes all elements from the deque.
+        void clear();
+
+        // Moves all of `that`'s elements to the back of this deque, leaving
+        // `that` empty. Undefined if the combined size exceeds N.
+        void splice(StaticDeque &that);
+
+        // The destructor.
+        ~StaticDeque();
+
+    private:
+        static constexpr bool pow2_ = (N & (N - 1)) == 0;
+
+        // Maps i in [0, 2N) to a slot index in [0, N).
+        static size_t wrap_(size_t i) {
+            return pow2_ ? (i & (N - 1)) : (i < N ? i : i - N);
+        }
+
+        T *slot_(size_t i) {
+            return reinterpret_cast<T *>(&storage_[i]);
+        }
+
+        const T *slot_(size_t i) const {
+            return reinterpret_cast<const T *>(&storage_[i]);
+        }
+
+        // Private member variables:
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_[N];
+        size_t head_;
+        size_t size_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, size_t N>
+    StaticDeque<T, N>::StaticDeque()
+            : head_(0), size_(0) {}
+
+    template<typename T, size_t N>
+    StaticDeque<T, N>::StaticDeque(std::initializer_list<T> args)
+            : StaticDeque() {
+        for (const auto &arg : args)
+            push_back(arg);
+    }
+
+    template<typename T, size_t N>
+    StaticDeque<T, N>::StaticDeque(const StaticDeque &other)
+            : StaticDeque() {
+        for (size_t i = 0; i < other.size_; ++i)
+            push_back(*other.slot_(wrap_(other.head_ + i)));
+    }
+
+    template<typename T, size_t N>
+    StaticDeque<T, N>::StaticDeque(StaticDeque &&other) noexcept(
+            std::is_nothrow_move_constructible<T>::value)
+            : StaticDeque() {
+        for (size_t i = 0; i < other.size_; ++i)
+            push_back(std::move(*other.slot_(wrap_(other.head_ + i))));
+        other.clear();
+    }
+
+    template<typename T, size_t N>
+    StaticDeque<T, N> &StaticDeque<T, N>::operator=(const StaticDeque &other) {
+        if (this == &other)
+            return *this;
+        clear();
+        for (size_t i = 0; i < other.size_; ++i)
+            push_back(*other.slot_(wrap_(other.head_ + i)));
+        return *this;
+    }
+
+    template<typename T, size_t N>
+    StaticDeque<T, N> &StaticDeque<T, N>::operator=(StaticDeque &&other) noexcept(
+            std::is_nothrow_move_constructible<T>::value) {
+        if (this == &other)
+            return *this;
+        clear();
+        for (size_t i = 0; i < other.size_; ++i)
+            push_back(std::move(*other.slot_(wrap_(other.head_ + i))));
+        other.clear();
+        return *this;
+    }
+
+    template<typename T, size_t N>
+    bool StaticDeque<T, N>::empty() const {
+        return size_ == 0;
+    }
+
+    template<typename T, size_t N>
+    bool StaticDeque<T, N>::full() const {
+        return size_ == N;
+    }
+
+    template<typename T, size_t N>
+    size_t StaticDeque<T, N>::size() const {
+        return size_;
+    }
+
+    template<typename T, size_t N>
+    const T &StaticDeque<T, N>::front() const {
+        return *slot_(head_);
+    }
+
+    template<typename T, size_t N>
+    T &StaticDeque<T, N>::front() {
+        return *slot_(head_);
+    }
+
+    template<typename T, size_t N>
+    const T &StaticDeque<T, N>::back() const {
+        return *slot_(wrap_(head_ + size_ - 1));
+    }
+
+    template<typename T, size_t N>
+    T &StaticDeque<T, N>::back() {
+        return *slot_(wrap_(head_ + size_ - 1));
+    }
+
+    template<typename T, size_t N>
+    void StaticDeque<T, N>::push_front(const T &value) {
+        assert(!full());
+        size_t h = wrap_(head_ + N - 1);
+        ::new(static_cast<void *>(slot_(h))) T(value);
+        head_ = h;
+        size_++;
+    }
+
+    template<typename T, size_t N>
+    void StaticDeque<T, N>::push_front(T &&value) {
+        assert(!full());
+        size_t h = wrap_(head_ + N - 1);
+        ::new(static_cast<void *>(slot_(h))) T(std::move(value));
+        head_ = h;
+        size_++;
+    }
+
+    template<typename T, size_t N>
+    void StaticDeque<T, N>::push_back(const T &value) {
+        assert(!full());
+        ::new(static_cast<void *>(slot_(wrap_(head_ + size_)))) T(value);
+        size_++;
+    }
+
+    template<typename T, size_t N>
+    void StaticDeque<T, N>::push_back(T &&value) {
+        assert(!full());
+        ::new(static_cast<void *>(slot_(wrap_(head_ + size_)))) T(std::move(value));
+        size_++;
+    }
+
+    template<typename T, size_t N>
+    bool StaticDeque<T, N>::try_push_front(const T &value) {
+        if (full())
+            return false;
+        push_front(value);
+        return true;
+    }
+
+    template<typename T, size_t N>
+    bool StaticDeque<T, N>::try_push_back(const T &value) {
+        if (full())
+            return false;
+        push_back(value);
+        return true;
+    }
+
+    template<typename T, size_t N>
+    void StaticDeque<T, N>::pop_front() {
+        if (empty())
+            return;
+        slot_(head_)->~T();
+        head_ = wrap_(head_ + 1);
+        size_--;
+    }
+
+    template<typename T, size_t N>
+    void StaticDeque<T, N>::pop_back() {
+        if (empty())
+            return;
+        slot_(wrap_(head_ + size_ - 1))->~T();
+        size_--;
+    }
+
+    template<typename T, size_t N>
+    void StaticDeque<T, N>::clear() {
+        while (!empty()) {
+            pop_front();
+        }
+        head_ = 0;
+    }
+
+    template<typename T, size_t N>
+    void StaticDeque<T, N>::splice(StaticDeque &that) {
+        if (this == &that)
+            return;
+        assert(size_ + that.size_ <= N);
+        while (!that.empty()) {
+            push_back(std::move(that.front()));
+            that.pop_front();
+        }
+    }
+
+    template<typename T, size_t N>
+    StaticDeque<T, N>::~StaticDeque() {
+        clear();
+    }
+}
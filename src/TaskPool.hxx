@@ -0,0 +1,346 @@
+#pragma once
+
+/*
+ * A fixed-size pool of worker threads that schedules tasks by work
+ * stealing. Each worker owns a `WorkStealingDeque` of tasks: it pushes and
+ * pops its own work at the back (so recursive jobs run depth-first and stay
+ * cache-warm) and, when it runs dry, steals from the front of a randomly
+ * chosen victim. Tasks submitted from outside the pool go through a small
+ * injection queue. Idle workers spin briefly and then park on a condition
+ * variable until new work is announced.
+ */
+
+#include "Deque.hxx"
+#include "WorkStealingDeque.hxx"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ipd {
+
+    class TaskPool {
+    public:
+        // Starts a pool with the given number of worker threads (at least
+        // one). Defaults to the number of hardware threads.
+        explicit TaskPool(size_t threads = std::thread::hardware_concurrency());
+
+        TaskPool(const TaskPool &) = delete;
+
+        TaskPool &operator=(const TaskPool &) = delete;
+
+        // Returns the number of worker threads.
+        size_t size() const;
+
+        // Schedules `f()` to run on some worker. When called from inside a
+        // task the new task goes on the calling worker's own deque. Tasks
+        // must not throw.
+        template<typename F>
+        void submit(F &&f);
+
+        // Calls `body(i)` for every `i` in [begin, end), splitting the range
+        // recursively into tasks of at most `grain` iterations, and returns
+        // once all of them have finished. The calling thread runs tasks while
+        // it waits, so nested calls from inside tasks are fine.
+        template<typename F>
+        void parallel_for(size_t begin, size_t end, F &&body, size_t grain = 1);
+
+        // Blocks until every submitted task has finished. Must not be called
+        // from inside a task, since that task would be waiting for itself.
+        void wait_idle();
+
+        // Waits for outstanding tasks, then stops and joins the workers.
+        ~TaskPool();
+
+    private:
+        struct task_ {
+            std::function<void()> fn;
+        };
+
+        struct worker_ {
+            WorkStealingDeque<task_ *> tasks;
+            std::minstd_rand rng;
+            std::thread thread;
+        };
+
+        // Identifies the pool and worker that the calling thread belongs to.
+        struct context_ {
+            TaskPool *pool;
+            size_t index;
+        };
+
+        static context_ &context_of_this_thread_();
+
+        // Returns the calling thread's worker if it belongs to this pool.
+        worker_ *current_worker_();
+
+        // The main loop of worker thread `index`.
+        void run_(size_t index);
+
+        // Finds one task (local deque, then injection queue, then stealing)
+        // and runs it. Returns false if no task was found.
+        bool run_one_(worker_ *self);
+
+        task_ *find_task_(worker_ *self);
+
+        task_ *steal_(worker_ *self);
+
+        void execute_(task_ *);
+
+        void enqueue_(task_ *);
+
+        // Wakes one parked worker, if any are parked.
+        void notify_work_();
+
+        template<typename F>
+        void for_range_(size_t begin, size_t end, size_t grain, F &body,
+                        std::atomic<size_t> &remaining);
+
+        // Number of spin-and-yield rounds before an idle worker parks.
+        static constexpr int spin_rounds_ = 64;
+
+        // Private member variables:
+        std::vector<std::unique_ptr<worker_>> workers_;
+
+        std::mutex inject_mutex_;
+        Deque<task_ *> inject_;
+        std::atomic<size_t> injected_;
+
+        // Tasks submitted but not yet finished.
+        std::atomic<size_t> pending_;
+
+        // Parking. `epoch_` is bumped (under `park_mutex_`) every time work
+        // is announced, so a worker that saw an old epoch before rechecking
+        // for work never sleeps through a wakeup.
+        std::mutex park_mutex_;
+        std::condition_variable park_cv_;
+        std::condition_variable idle_cv_;
+        std::atomic<size_t> sleepers_;
+        size_t epoch_;
+        bool stopping_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    inline TaskPool::TaskPool(size_t threads)
+            : injected_(0), pending_(0), sleepers_(0), epoch_(0),
+              stopping_(false) {
+        if (threads == 0)
+            threads = 1;
+
+        std::random_device seed;
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back(new worker_);
+            workers_.back()->rng.seed(seed());
+        }
+        for (size_t i = 0; i < threads; ++i)
+            workers_[i]->thread = std::thread([this, i] { run_(i); });
+    }
+
+    inline size_t TaskPool::size() const {
+        return workers_.size();
+    }
+
+    template<typename F>
+    void TaskPool::submit(F &&f) {
+        task_ *task = new task_{std::function<void()>(std::forward<F>(f))};
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        enqueue_(task);
+    }
+
+    template<typename F>
+    void TaskPool::parallel_for(size_t begin, size_t end, F &&body,
+                                size_t grain) {
+        if (begin >= end)
+            return;
+        if (grain == 0)
+            grain = 1;
+
+        std::atomic<size_t> remaining(end - begin);
+        for_range_(begin, end, grain, body, remaining);
+
+        worker_ *self = current_worker_();
+        int spins = 0;
+        while (remaining.load(std::memory_order_acquire) != 0) {
+            if (run_one_(self))
+                spins = 0;
+            else if (++spins > spin_rounds_)
+                std::this_thread::yield();
+        }
+    }
+
+    template<typename F>
+    void TaskPool::for_range_(size_t begin, size_t end, size_t grain, F &body,
+                              std::atomic<size_t> &remaining) {
+        // Hand off the upper half until what is left is one grain; the
+        // handed-off halves split themselves the same way when they run.
+        while (end - begin > grain) {
+            size_t mid = begin + (end - begin) / 2;
+            submit([this, mid, end, grain, &body, &remaining] {
+                for_range_(mid, end, grain, body, remaining);
+            });
+            end = mid;
+        }
+
+        for (size_t i = begin; i < end; ++i)
+            body(i);
+
+        remaining.fetch_sub(end - begin, std::memory_order_acq_rel);
+    }
+
+    inline void TaskPool::wait_idle() {
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        idle_cv_.wait(lock, [this] {
+            return pending_.load(std::memory_order_acquire) == 0;
+        });
+    }
+
+    inline TaskPool::~TaskPool() {
+        wait_idle();
+        {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            stopping_ = true;
+        }
+        park_cv_.notify_all();
+        for (auto &w : workers_)
+            w->thread.join();
+    }
+
+    inline TaskPool::context_ &TaskPool::context_of_this_thread_() {
+        static thread_local context_ context{nullptr, 0};
+        return context;
+    }
+
+    inline TaskPool::worker_ *TaskPool::current_worker_() {
+        context_ &context = context_of_this_thread_();
+        return context.pool == this ? workers_[context.index].get() : nullptr;
+    }
+
+    inline void TaskPool::run_(size_t index) {
+        context_of_this_thread_() = context_{this, index};
+        worker_ *self = workers_[index].get();
+
+        int spins = 0;
+        for (;;) {
+            if (run_one_(self)) {
+                spins = 0;
+                continue;
+            }
+            if (++spins < spin_rounds_) {
+                std::this_thread::yield();
+                continue;
+            }
+            spins = 0;
+
+            // Announce that we are about to sleep, then look for work one
+            // last time. A producer either sees `sleepers_ > 0` and bumps the
+            // epoch, or its task is visible to this final check.
+            size_t seen;
+            {
+                std::lock_guard<std::mutex> lock(park_mutex_);
+                if (stopping_)
+                    return;
+                seen = epoch_;
+            }
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+
+            task_ *task = find_task_(self);
+            if (task != nullptr) {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                execute_(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(park_mutex_);
+            park_cv_.wait(lock, [&] { return stopping_ || epoch_ != seen; });
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            if (stopping_)
+                return;
+        }
+    }
+
+    inline bool TaskPool::run_one_(worker_ *self) {
+        task_ *task = find_task_(self);
+        if (task == nullptr)
+            return false;
+        execute_(task);
+        return true;
+    }
+
+    inline TaskPool::task_ *TaskPool::find_task_(worker_ *self) {
+        task_ *task = nullptr;
+        if (self != nullptr && self->tasks.try_pop_back(task))
+            return task;
+
+        if (injected_.load(std::memory_order_acquire) != 0) {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            if (!inject_.empty()) {
+                task = inject_.front();
+                inject_.pop_front();
+                injected_.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+
+        return steal_(self);
+    }
+
+    inline TaskPool::task_ *TaskPool::steal_(worker_ *self) {
+        size_t n = workers_.size();
+        size_t start = self != nullptr
+                       ? self->rng() % n
+                       : std::hash<std::thread::id>()(std::this_thread::get_id()) % n;
+
+        // Two sweeps from a random starting victim: a steal can fail
+        // spuriously when it loses a race, so one sweep is not conclusive.
+        task_ *task = nullptr;
+        for (size_t k = 0; k < 2 * n; ++k) {
+            worker_ *victim = workers_[(start + k) % n].get();
+            if (victim != self && victim->tasks.try_steal_front(task))
+                return task;
+        }
+        return nullptr;
+    }
+
+    inline void TaskPool::execute_(task_ *task) {
+        task->fn();
+        delete task;
+
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            idle_cv_.notify_all();
+        }
+    }
+
+    inline void TaskPool::enqueue_(task_ *task) {
+        worker_ *self = current_worker_();
+        if (self != nullptr) {
+            self->tasks.push_back(task);
+        } else {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            inject_.push_back(task);
+            injected_.fetch_add(1, std::memory_order_release);
+        }
+        notify_work_();
+    }
+
+    inline void TaskPool::notify_work_() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) == 0)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            ++epoch_;
+        }
+        park_cv_.notify_one();
+    }
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+/*
+ * A FIFO of events that only cares about the last `window` of time. Each
+ * element is stamped when it is pushed, and an element is stale once its
+ * stamp is more than `window` before "now". Stale elements are evicted in
+ * batches: by `expire`, and by every push, which first drops whatever the
+ * new stamp has made stale. Reads never evict, so `empty` followed by
+ * `front` always agree; call `expire` first to see only the live window.
+ *
+ * Elements and stamps live in two parallel ring buffers, so the stamps
+ * are packed together. Stamps never decrease from front to back, and
+ * expiry binary-searches them for the first live one; the payloads are
+ * touched only to run their destructors, which is skipped entirely for
+ * trivially destructible T. `count_in_window` is a binary search as well.
+ *
+ * `Clock` is any type meeting the standard Clock requirements.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ipd {
+
+    template<typename T, typename Clock = std::chrono::steady_clock>
+    class TimeWindowDeque {
+    public:
+        using duration = typename Clock::duration;
+        using time_point = typename Clock::time_point;
+
+        // Constructs a new, empty deque that keeps the last `window`.
+        explicit TimeWindowDeque(duration window);
+
+        TimeWindowDeque(const TimeWindowDeque &) = delete;
+
+        TimeWindowDeque &operator=(const TimeWindowDeque &) = delete;
+
+        ~TimeWindowDeque();
+
+        // Returns the width of the window.
+        duration window() const;
+
+        // Returns true if the deque is empty. Stale elements that have not
+        // been evicted yet count.
+        bool empty() const;
+
+        // Returns the number of elements in the deque, including stale ones
+        // that have not been evicted yet.
+        size_t size() const;
+
+        // Returns the number of elements that are live at `now`, without
+        // evicting anything.
+        size_t count_in_window(time_point now) const;
+
+        size_t count_in_window() const;
+
+        // Returns a reference to the first (oldest) element. If the deque is
+        // empty then the behavior is undefined.
+        const T &front() const;
+
+        // Returns a reference to the last (newest) element. If the deque is
+        // empty then the behavior is undefined.
+        const T &back() const;
+
+        // Returns the stamp of the first (last) element. If the deque is
+        // empty then the behavior is undefined.
+        time_point front_time() const;
+
+        time_point back_time() const;
+
+        // Evicts the elements that are stale at `stamp`, then inserts a new
+        // element stamped `stamp` at the back. A stamp earlier than the
+        // newest one is raised to it, so stamps never decrease.
+        void push_back(const T &, time_point stamp);
+
+        void push_back(const T &value);
+
+        // Removes the first element of the deque. Does nothing if the
+        // deque is empty.
+        void pop_front();
+
+        // Evicts the elements that are stale at `now`, and returns how many
+        // were evicted.
+        size_t expire(time_point now);
+
+        size_t expire();
+
+        // Removes all elements from the deque.
+        void clear();
+
+    private:
+        using storage_ = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+        T &value_(size_t i) {
+            return *reinterpret_cast<T *>(&values_[(head_ + i) & mask_]);
+        }
+
+        const T &value_(size_t i) const {
+            return *reinterpret_cast<const T *>(&values_[(head_ + i) & mask_]);
+        }
+
+        time_point stamp_(size_t i) const { return stamps_[(head_ + i) & mask_]; }
+
+        // Returns the number of leading elements that are stale at `now`.
+        size_t stale_count_(time_point now) const;
+
+        // Destroys the first `n` elements.
+        void drop_front_(size_t n);
+
+        // Doubles the capacity of both rings.
+        void grow_();
+
+        // Private member variables:
+        std::unique_ptr<time_point[]> stamps_;
+        std::unique_ptr<storage_[]> values_;
+        size_t mask_;
+        size_t head_;
+        size_t size_;
+        duration window_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T, typename Clock>
+    TimeWindowDeque<T, Clock>::TimeWindowDeque(duration window)
+            // With no rings yet, a capacity of mask_ + 1 == 0 makes the first
+            // push allocate.
+            : mask_(size_t(-1)), head_(0), size_(0), window_(window) {}
+
+    template<typename T, typename Clock>
+    TimeWindowDeque<T, Clock>::~TimeWindowDeque() {
+        clear();
+    }
+
+    template<typename T, typename Clock>
+    typename TimeWindowDeque<T, Clock>::duration TimeWindowDeque<T, Clock>::window() const {
+        return window_;
+    }
+
+    template<typename T, typename Clock>
+    bool TimeWindowDeque<T, Clock>::empty() const {
+        return size_ == 0;
+    }
+
+    template<typename T, typename Clock>
+    size_t TimeWindowDeque<T, Clock>::size() const {
+        return size_;
+    }
+
+    template<typename T, typename Clock>
+    size_t TimeWindowDeque<T, Clock>::count_in_window(time_point now) const {
+        return size_ - stale_count_(now);
+    }
+
+    template<typename T, typename Clock>
+    size_t TimeWindowDeque<T, Clock>::count_in_window() const {
+        return count_in_window(Clock::now());
+    }
+
+    template<typename T, typename Clock>
+    const T &TimeWindowDeque<T, Clock>::front() const {
+        return value_(0);
+    }
+
+    template<typename T, typename Clock>
+    const T &TimeWindowDeque<T, Clock>::back() const {
+        return value_(size_ - 1);
+    }
+
+    template<typename T, typename Clock>
+    typename TimeWindowDeque<T, Clock>::time_point TimeWindowDeque<T, Clock>::front_time() const {
+        return stamp_(0);
+    }
+
+    template<typename T, typename Clock>
+    typename TimeWindowDeque<T, Clock>::time_point TimeWindowDeque<T, Clock>::back_time() const {
+        return stamp_(size_ - 1);
+    }
+
+    template<typename T, typename Clock>
+    void TimeWindowDeque<T, Clock>::push_back(const T &value, time_point stamp) {
+        if (!empty() && stamp < back_time())
+            stamp = back_time();
+        expire(stamp);
+        if (size_ == mask_ + 1)
+            grow_();
+
+        size_t slot = (head_ + size_) & mask_;
+        ::new(static_cast<void *>(&values_[slot])) T(value);
+        stamps_[slot] = stamp;
+        size_++;
+    }
+
+    template<typename T, typename Clock>
+    void TimeWindowDeque<T, Clock>::push_back(const T &value) {
+        push_back(value, Clock::now());
+    }
+
+    template<typename T, typename Clock>
+    void TimeWindowDeque<T, Clock>::pop_front() {
+        if (!empty())
+            drop_front_(1);
+    }
+
+    template<typename T, typename Clock>
+    size_t TimeWindowDeque<T, Clock>::expire(time_point now) {
+        size_t n = stale_count_(now);
+        drop_front_(n);
+        return n;
+    }
+
+    template<typename T, typename Clock>
+    size_t TimeWindowDeque<T, Clock>::expire() {
+        return expire(Clock::now());
+    }
+
+    template<typename T, typename Clock>
+    void TimeWindowDeque<T, Clock>::clear() {
+        drop_front_(size_);
+        head_ = 0;
+    }
+
+    template<typename T, typename Clock>
+    size_t TimeWindowDeque<T, Clock>::stale_count_(time_point now) const {
+        // An element is live while `now - stamp <= window`; written this way
+        // round, the test cannot overflow for stamps far in the past.
+        size_t lo = 0, hi = size_;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (stamp_(mid) < now - window_)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    template<typename T, typename Clock>
+    void TimeWindowDeque<T, Clock>::drop_front_(size_t n) {
+        assert(n <= size_);
+        if (!std::is_trivially_destructible<T>::value) {
+            for (size_t i = 0; i < n; ++i)
+                value_(i).~T();
+        }
+        head_ = (head_ + n) & mask_;
+        size_ -= n;
+    }
+
+    template<typename T, typename Clock>
+    void TimeWindowDeque<T, Clock>::grow_() {
+        size_t capacity = stamps_ ? 2 * (mask_ + 1) : 8;
+        std::unique_ptr<time_point[]> stamps(new time_point[capacity]);
+        std::unique_ptr<storage_[]> values(new storage_[capacity]);
+        for (size_t i = 0; i < size_; ++i) {
+            stamps[i] = stamp_(i);
+            ::new(static_cast<void *>(&values[i])) T(std::move(value_(i)));
+            value_(i).~T();
+        }
+        stamps_ = std::move(stamps);
+        values_ = std::move(values);
+        mask_ = capacity - 1;
+        head_ = 0;
+    }
+}
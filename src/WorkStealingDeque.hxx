@@ -0,0 +1,189 @@
+#pragma once
+
+/*
+ * A work-stealing deque, after Chase and Lev, "Dynamic Circular
+ * Work-Stealing Deque" (SPAA 2005), with the memory orderings from Lê et
+ * al., "Correct and Efficient Work-Stealing for Weak Memory Models"
+ * (PPoPP 2013).
+ *
+ * One thread owns the deque and pushes and pops at the back; any number
+ * of other threads may steal from the front. The elements live in a
+ * circular array that the owner doubles when it fills up.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ipd {
+
+    template<typename T>
+    class WorkStealingDeque {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "WorkStealingDeque elements are read racily by thieves "
+                      "and must be trivially copyable (e.g. pointers)");
+
+    public:
+        // Constructs a new, empty deque with room for `capacity` elements
+        // before the first resize. `capacity` is rounded up to a power of two.
+        explicit WorkStealingDeque(size_t capacity = 64);
+
+        WorkStealingDeque(const WorkStealingDeque &) = delete;
+
+        WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+        // Returns true if the deque appears empty. Only a hint when other
+        // threads are stealing concurrently.
+        bool empty() const;
+
+        // Returns the approximate number of elements in the deque.
+        size_t size() const;
+
+        // Inserts a new element at the back. Owner thread only.
+        void push_back(const T &);
+
+        // Removes the last element and stores it in the argument. Returns
+        // false if the deque was empty. Owner thread only.
+        bool try_pop_back(T &);
+
+        // Removes the first element and stores it in the argument. Returns
+        // false if the deque was empty or another thread won the race for
+        // the element. Safe to call from any thread.
+        bool try_steal_front(T &);
+
+        // The destructor.
+        ~WorkStealingDeque();
+
+    private:
+        // A power-of-two circular array indexed by the unbounded top and
+        // bottom counters.
+        struct ring_ {
+            explicit ring_(size_t cap)
+                    : mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+
+            size_t capacity() const { return mask + 1; }
+
+            T get(int64_t i) const {
+                return slots[size_t(i) & mask].load(std::memory_order_relaxed);
+            }
+
+            void put(int64_t i, const T &value) {
+                slots[size_t(i) & mask].store(value, std::memory_order_relaxed);
+            }
+
+            size_t mask;
+            std::unique_ptr<std::atomic<T>[]> slots;
+        };
+
+        // Replaces the current array with one twice as large. The old array
+        // is kept alive until destruction, since a thief may still be
+        // reading from it.
+        ring_ *grow_(ring_ *, int64_t top, int64_t bottom);
+
+        // Private member variables. `top_` is contended by thieves and
+        // `bottom_` is written by the owner, so they are padded apart onto
+        // separate cache lines.
+        std::atomic<int64_t> top_;
+        char pad_[64 - sizeof(std::atomic<int64_t>)];
+        std::atomic<int64_t> bottom_;
+        std::atomic<ring_ *> array_;
+        std::vector<std::unique_ptr<ring_>> rings_;
+    };
+
+///
+/// IMPLEMENTATIONS
+///
+
+    template<typename T>
+    WorkStealingDeque<T>::WorkStealingDeque(size_t capacity)
+            : top_(0), bottom_(0), array_(nullptr) {
+        size_t cap = 1;
+        while (cap < capacity)
+            cap *= 2;
+        rings_.emplace_back(new ring_(cap));
+        array_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    bool WorkStealingDeque<T>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename T>
+    size_t WorkStealingDeque<T>::size() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? size_t(b - t) : 0;
+    }
+
+    template<typename T>
+    void WorkStealingDeque<T>::push_back(const T &value) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        ring_ *a = array_.load(std::memory_order_relaxed);
+        if (b - t > int64_t(a->capacity()) - 1)
+            a = grow_(a, t, b);
+        a->put(b, value);
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    template<typename T>
+    bool WorkStealingDeque<T>::try_pop_back(T &out) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        ring_ *a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        out = a->get(b);
+        if (t == b) {
+            // Last element: race any thieves for it.
+            bool won = top_.compare_exchange_strong(t, t + 1,
+                                                    std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    template<typename T>
+    bool WorkStealingDeque<T>::try_steal_front(T &out) {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b)
+            return false;
+
+        ring_ *a = array_.load(std::memory_order_acquire);
+        T value = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1,
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return false;
+        out = value;
+        return true;
+    }
+
+    template<typename T>
+    typename WorkStealingDeque<T>::ring_ *
+    WorkStealingDeque<T>::grow_(ring_ *old, int64_t top, int64_t bottom) {
+        rings_.emplace_back(new ring_(2 * old->capacity()));
+        ring_ *a = rings_.back().get();
+        for (int64_t i = top; i < bottom; ++i)
+            a->put(i, old->get(i));
+        array_.store(a, std::memory_order_release);
+        return a;
+    }
+
+    template<typename T>
+    WorkStealingDeque<T>::~WorkStealingDeque() = default;
+}
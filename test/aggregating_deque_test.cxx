@@ -0,0 +1,135 @@
+#include "AggregatingDeque.hxx"
+
+#include <catch.hxx>
+
+#include <deque>
+#include <random>
+#include <string>
+
+using namespace ipd;
+
+namespace {
+    struct GcdMonoid {
+        long identity() const { return 0; }
+
+        long operator()(long a, long b) const
+        {
+            while (b != 0) {
+                long t = a % b;
+                a = b;
+                b = t;
+            }
+            return a;
+        }
+    };
+
+    // String concatenation: associative but not commutative, so it checks
+    // that elements are combined oldest first.
+    struct ConcatMonoid {
+        std::string identity() const { return ""; }
+
+        std::string operator()(const std::string &a, const std::string &b) const
+        {
+            return a + b;
+        }
+    };
+
+    // A monoid with state, to check that the deque uses its own copy.
+    struct ModularSum {
+        explicit ModularSum(long m) : m(m) {}
+
+        long identity() const { return 0; }
+
+        long operator()(long a, long b) const { return (a + b) % m; }
+
+        long m;
+    };
+}
+
+TEST_CASE("Aggregating_new_is_empty")
+{
+    AggregatingDeque<int> window;
+    CHECK(window.empty());
+    CHECK(window.size() == 0);
+    CHECK(window.query() == 0);
+}
+
+TEST_CASE("Aggregating_sum_follows_pushes_and_pops")
+{
+    AggregatingDeque<int> window;
+    window.push_back(1);
+    window.push_back(2);
+    window.push_back(3);
+    CHECK(window.query() == 6);
+    window.pop_front();
+    CHECK(window.query() == 5);
+    window.push_back(10);
+    CHECK(window.query() == 15);
+    CHECK(window.front() == 2);
+    CHECK(window.back() == 10);
+    window.pop_front();
+    window.pop_front();
+    window.pop_front();
+    CHECK(window.empty());
+    CHECK(window.query() == 0);
+    window.pop_front();
+    CHECK(window.empty());
+}
+
+TEST_CASE("Aggregating_gcd_window")
+{
+    AggregatingDeque<long, GcdMonoid> window;
+    window.push_back(12);
+    window.push_back(18);
+    CHECK(window.query() == 6);
+    window.push_back(8);
+    CHECK(window.query() == 2);
+    window.pop_front();
+    window.pop_front();
+    CHECK(window.query() == 8);
+}
+
+TEST_CASE("Aggregating_combines_oldest_first")
+{
+    AggregatingDeque<std::string, ConcatMonoid> window;
+    std::deque<std::string> ref;
+    std::mt19937 rng(9);
+    for (int step = 0; step < 2000; ++step) {
+        if (ref.empty() || rng() % 3 != 0) {
+            std::string s(1, char('a' + rng() % 26));
+            window.push_back(s);
+            ref.push_back(s);
+        } else {
+            window.pop_front();
+            ref.pop_front();
+        }
+        std::string expected;
+        for (const std::string &s : ref)
+            expected += s;
+        REQUIRE(window.query() == expected);
+        REQUIRE(window.size() == ref.size());
+    }
+}
+
+TEST_CASE("Aggregating_uses_given_monoid")
+{
+    AggregatingDeque<long, ModularSum> window(ModularSum(7));
+    window.push_back(5);
+    window.push_back(4);
+    CHECK(window.query() == 2);
+    window.pop_front();
+    CHECK(window.query() == 4);
+}
+
+TEST_CASE("Aggregating_clear_resets_query")
+{
+    AggregatingDeque<int> window;
+    window.push_back(4);
+    window.push_back(5);
+    window.pop_front();
+    window.clear();
+    CHECK(window.empty());
+    CHECK(window.query() == 0);
+    window.push_back(3);
+    CHECK(window.query() == 3);
+}
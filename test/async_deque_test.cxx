@@ -0,0 +1,193 @@
+#include "AsyncDeque.hxx"
+
+#include <catch.hxx>
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    // A single-threaded event loop: `execute` queues a coroutine and
+    // `run` resumes queued coroutines until there are none left.
+    struct EventLoop {
+        std::deque<std::coroutine_handle<>> ready;
+
+        void run()
+        {
+            while (!ready.empty()) {
+                std::coroutine_handle<> h = ready.front();
+                ready.pop_front();
+                h.resume();
+            }
+        }
+    };
+
+    struct LoopExecutor {
+        EventLoop *loop;
+
+        void execute(std::coroutine_handle<> h) const
+        {
+            loop->ready.push_back(h);
+        }
+    };
+
+    // A fire-and-forget coroutine that starts eagerly and frees itself
+    // when it finishes.
+    struct task {
+        struct promise_type {
+            task get_return_object() { return {}; }
+            std::suspend_never initial_suspend() { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    template<typename Q>
+    task consume(Q &q, int n, std::vector<int> &out)
+    {
+        for (int i = 0; i < n; ++i)
+            out.push_back(co_await q.pop_front());
+    }
+
+    template<typename Q>
+    task produce(Q &q, int first, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            q.push_back(first + i);
+        co_return;
+    }
+
+    task forward(AsyncDeque<int, LoopExecutor> &in,
+                 AsyncDeque<int, LoopExecutor> &out, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            out.push_back(co_await in.pop_front() + 1);
+    }
+}
+
+TEST_CASE("New_is_empty")
+{
+    AsyncDeque<int> q;
+    CHECK(q.empty());
+    CHECK(q.size() == 0);
+    CHECK(q.waiting() == 0);
+}
+
+TEST_CASE("Try_pop_front")
+{
+    AsyncDeque<int> q;
+    int x = 0;
+    CHECK_FALSE(q.try_pop_front(x));
+    q.push_back(5);
+    CHECK(q.size() == 1);
+    CHECK(q.try_pop_front(x));
+    CHECK(x == 5);
+}
+
+TEST_CASE("Await_ready_element_does_not_suspend")
+{
+    AsyncDeque<int> q;
+    q.push_back(5);
+    q.push_back(6);
+    std::vector<int> got;
+    consume(q, 2, got);
+    CHECK(got == std::vector<int>{5, 6});
+    CHECK(q.waiting() == 0);
+}
+
+TEST_CASE("Awaiting_empty_deque_suspends_until_push")
+{
+    AsyncDeque<int> q;
+    std::vector<int> got;
+    consume(q, 2, got);
+    CHECK(got.empty());
+    CHECK(q.waiting() == 1);
+
+    q.push_back(5);
+    CHECK(got == std::vector<int>{5});
+    CHECK(q.waiting() == 1);
+
+    q.push_back(6);
+    CHECK(got == std::vector<int>{5, 6});
+    CHECK(q.waiting() == 0);
+    CHECK(q.empty());
+}
+
+TEST_CASE("Waiters_are_served_in_order")
+{
+    AsyncDeque<int> q;
+    std::vector<int> a, b;
+    consume(q, 1, a);
+    consume(q, 1, b);
+    CHECK(q.waiting() == 2);
+    q.push_back(5);
+    q.push_back(6);
+    CHECK(a == std::vector<int>{5});
+    CHECK(b == std::vector<int>{6});
+}
+
+TEST_CASE("Executor_defers_resumption")
+{
+    EventLoop loop;
+    AsyncDeque<int, LoopExecutor> q(LoopExecutor{&loop});
+    std::vector<int> got;
+    consume(q, 3, got);
+
+    produce(q, 10, 3);
+    CHECK(got.empty());
+    CHECK(loop.ready.size() == 1);
+
+    loop.run();
+    CHECK(got == std::vector<int>{10, 11, 12});
+}
+
+TEST_CASE("Pipeline_on_event_loop")
+{
+    EventLoop loop;
+    AsyncDeque<int, LoopExecutor> a(LoopExecutor{&loop});
+    AsyncDeque<int, LoopExecutor> b(LoopExecutor{&loop});
+    AsyncDeque<int, LoopExecutor> c(LoopExecutor{&loop});
+    std::vector<int> got;
+
+    consume(c, 1000, got);
+    forward(b, c, 1000);
+    forward(a, b, 1000);
+    produce(a, 0, 1000);
+    loop.run();
+
+    REQUIRE(got.size() == 1000);
+    CHECK(got.front() == 2);
+    CHECK(got.back() == 1001);
+}
+
+TEST_CASE("Non_trivial_elements")
+{
+    AsyncDeque<std::string> q;
+    std::vector<std::string> got;
+    [](AsyncDeque<std::string> &q, std::vector<std::string> &got) -> task {
+        got.push_back(co_await q.pop_front());
+    }(q, got);
+    q.push_back("hello");
+    REQUIRE(got.size() == 1);
+    CHECK(got[0] == "hello");
+}
+
+TEST_CASE("Producer_on_another_thread")
+{
+    AsyncDeque<int> q;
+    std::vector<int> got;
+    consume(q, 1000, got);
+    std::thread producer([&] {
+        for (int i = 0; i < 1000; ++i)
+            q.push_back(i);
+    });
+    producer.join();
+    REQUIRE(got.size() == 1000);
+    CHECK(got.back() == 999);
+}
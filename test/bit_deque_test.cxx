@@ -0,0 +1,162 @@
+#include "BitDeque.hxx"
+
+#include <catch.hxx>
+
+#include <deque>
+#include <random>
+
+using namespace ipd;
+
+namespace {
+    // Checks every query against a reference std::deque<bool>.
+    void check_same(const BitDeque &bits, const std::deque<bool> &ref)
+    {
+        REQUIRE(bits.size() == ref.size());
+        size_t set = 0, first = BitDeque::npos, last = BitDeque::npos;
+        size_t first_clear = BitDeque::npos, last_clear = BitDeque::npos;
+        for (size_t i = 0; i < ref.size(); ++i) {
+            REQUIRE(bits[i] == ref[i]);
+            if (ref[i]) {
+                set++;
+                if (first == BitDeque::npos)
+                    first = i;
+                last = i;
+            } else {
+                if (first_clear == BitDeque::npos)
+                    first_clear = i;
+                last_clear = i;
+            }
+        }
+        CHECK(bits.count() == set);
+        CHECK(bits.find_first() == first);
+        CHECK(bits.find_last() == last);
+        CHECK(bits.find_first(false) == first_clear);
+        CHECK(bits.find_last(false) == last_clear);
+    }
+}
+
+TEST_CASE("Bit_new_is_empty")
+{
+    BitDeque bits;
+    CHECK(bits.empty());
+    CHECK(bits.size() == 0);
+    CHECK(bits.count() == 0);
+    CHECK(bits.find_first() == BitDeque::npos);
+    CHECK(bits.find_last() == BitDeque::npos);
+}
+
+TEST_CASE("Bit_push_and_pop_both_ends")
+{
+    BitDeque bits;
+    bits.push_back(true);
+    bits.push_front(false);
+    bits.push_back(false);
+    CHECK(bits.size() == 3);
+    CHECK_FALSE(bits.front());
+    CHECK(bits[1]);
+    CHECK_FALSE(bits.back());
+    bits.pop_front();
+    CHECK(bits.front());
+    bits.pop_back();
+    CHECK(bits.back());
+    bits.pop_back();
+    CHECK(bits.empty());
+    bits.pop_front();
+    CHECK(bits.empty());
+}
+
+TEST_CASE("Bit_set_changes_one_bit")
+{
+    BitDeque bits{false, false, false};
+    bits.set(1, true);
+    CHECK(bits.count() == 1);
+    CHECK(bits.find_first() == 1);
+    bits.set(1, false);
+    CHECK(bits.count() == 0);
+}
+
+TEST_CASE("Bit_queries_across_word_boundaries")
+{
+    BitDeque bits;
+    std::deque<bool> ref;
+    for (int i = 0; i < 200; ++i) {
+        bits.push_back(false);
+        ref.push_back(false);
+    }
+    check_same(bits, ref);
+    bits.set(63, true);
+    ref[63] = true;
+    bits.set(64, true);
+    ref[64] = true;
+    bits.set(199, true);
+    ref[199] = true;
+    check_same(bits, ref);
+}
+
+TEST_CASE("Bit_rolling_window_wraps_the_ring")
+{
+    BitDeque bits;
+    std::deque<bool> ref;
+    for (int tick = 0; tick < 1000; ++tick) {
+        bool flag = tick % 7 == 0 || tick % 11 == 0;
+        bits.push_back(flag);
+        ref.push_back(flag);
+        if (ref.size() > 150) {
+            bits.pop_front();
+            ref.pop_front();
+        }
+    }
+    check_same(bits, ref);
+}
+
+TEST_CASE("Bit_random_operations_match_std_deque")
+{
+    std::mt19937 rng(3);
+    BitDeque bits;
+    std::deque<bool> ref;
+    for (int step = 0; step < 20000; ++step) {
+        bool value = rng() % 3 == 0;
+        switch (rng() % 5) {
+            case 0:
+                bits.push_front(value);
+                ref.push_front(value);
+                break;
+            case 1:
+            case 2:
+                bits.push_back(value);
+                ref.push_back(value);
+                break;
+            case 3:
+                bits.pop_front();
+                if (!ref.empty())
+                    ref.pop_front();
+                break;
+            default:
+                bits.pop_back();
+                if (!ref.empty())
+                    ref.pop_back();
+                break;
+        }
+        if (step % 1000 == 0)
+            check_same(bits, ref);
+    }
+    check_same(bits, ref);
+}
+
+TEST_CASE("Bit_copy_and_assign")
+{
+    BitDeque bits{true, false, true};
+    BitDeque copy(bits);
+    bits.pop_front();
+    CHECK(copy.size() == 3);
+    CHECK(copy.count() == 2);
+    copy = bits;
+    CHECK(copy.size() == 2);
+    CHECK_FALSE(copy.front());
+    BitDeque &alias = copy;
+    copy = alias;
+    CHECK(copy.size() == 2);
+    BitDeque empty;
+    copy = empty;
+    CHECK(copy.empty());
+}
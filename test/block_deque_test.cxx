@@ -0,0 +1,222 @@
+#include "BlockDeque.hxx"
+
+#include <catch.hxx>
+
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    // Counts copies and live instances, to see what copy-on-write copies.
+    struct Tracked {
+        static int copies;
+        static int live;
+
+        explicit Tracked(int v) : v(v) { live++; }
+
+        Tracked(const Tracked &other) : v(other.v) {
+            copies++;
+            live++;
+        }
+
+        Tracked &operator=(const Tracked &) = delete;
+
+        ~Tracked() { live--; }
+
+        int v;
+    };
+
+    int Tracked::copies = 0;
+    int Tracked::live = 0;
+
+    template<typename T, size_t B>
+    std::vector<int> values(const BlockDeque<T, B> &dq)
+    {
+        std::vector<int> result;
+        for (const auto &x : dq)
+            result.push_back(x.v);
+        return result;
+    }
+
+    std::vector<int> ints(const BlockDeque<int, 4> &dq)
+    {
+        return std::vector<int>(dq.begin(), dq.end());
+    }
+}
+
+TEST_CASE("Block_new_is_empty")
+{
+    BlockDeque<int> dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.begin() == dq.end());
+}
+
+TEST_CASE("Block_push_and_pop_across_blocks")
+{
+    BlockDeque<int, 4> dq;
+    for (int i = 0; i < 10; ++i)
+        dq.push_back(i);
+    for (int i = 1; i <= 10; ++i)
+        dq.push_front(-i);
+    CHECK(dq.size() == 20);
+    CHECK(dq.front() == -10);
+    CHECK(dq.back() == 9);
+    for (int i = 0; i < 10; ++i)
+        dq.pop_front();
+    CHECK(ints(dq) == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    for (int i = 0; i < 10; ++i)
+        dq.pop_back();
+    CHECK(dq.empty());
+    dq.pop_back();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Block_random_operations_match_std_deque")
+{
+    std::mt19937 rng(8);
+    BlockDeque<int, 4> dq;
+    std::deque<int> ref;
+    std::vector<BlockDeque<int, 4>> snapshots;
+    std::vector<std::deque<int>> expected;
+    for (int step = 0; step < 5000; ++step) {
+        int v = int(rng() % 100);
+        switch (rng() % 5) {
+            case 0:
+                dq.push_front(v);
+                ref.push_front(v);
+                break;
+            case 1:
+                dq.push_back(v);
+                ref.push_back(v);
+                break;
+            case 2:
+                dq.pop_front();
+                if (!ref.empty())
+                    ref.pop_front();
+                break;
+            case 3:
+                dq.pop_back();
+                if (!ref.empty())
+                    ref.pop_back();
+                break;
+            default:
+                if (!ref.empty()) {
+                    dq.front() += 1;
+                    ref.front() += 1;
+                }
+                break;
+        }
+        REQUIRE(dq.size() == ref.size());
+        if (step % 250 == 0) {
+            snapshots.push_back(dq);
+            expected.push_back(ref);
+        }
+    }
+    CHECK(ints(dq) == std::vector<int>(ref.begin(), ref.end()));
+    for (size_t i = 0; i < snapshots.size(); ++i)
+        CHECK(ints(snapshots[i]) ==
+              std::vector<int>(expected[i].begin(), expected[i].end()));
+}
+
+TEST_CASE("Block_copy_copies_no_elements")
+{
+    Tracked::copies = 0;
+    {
+        BlockDeque<Tracked, 8> dq;
+        for (int i = 0; i < 64; ++i)
+            dq.push_back(Tracked(i));
+        int before = Tracked::copies;
+        BlockDeque<Tracked, 8> copy(dq);
+        CHECK(Tracked::copies == before);
+        CHECK(values(copy) == values(dq));
+    }
+    CHECK(Tracked::live == 0);
+}
+
+TEST_CASE("Block_write_clones_only_the_touched_block")
+{
+    {
+        BlockDeque<Tracked, 8> dq;
+        for (int i = 0; i < 64; ++i)
+            dq.push_back(Tracked(i));
+        BlockDeque<Tracked, 8> copy(dq);
+
+        int before = Tracked::copies;
+        copy.back().v = 1000;
+        CHECK(Tracked::copies - before == 8);
+        CHECK(dq.back().v == 63);
+        CHECK(copy.back().v == 1000);
+
+        // The block is now unique, so further writes copy nothing.
+        before = Tracked::copies;
+        copy.back().v = 2000;
+        copy.push_front(Tracked(-1));
+        CHECK(Tracked::copies - before == 1);  // the pushed element itself
+    }
+    CHECK(Tracked::live == 0);
+}
+
+TEST_CASE("Block_pops_on_shared_blocks_do_not_clone")
+{
+    {
+        BlockDeque<Tracked, 8> dq;
+        for (int i = 0; i < 16; ++i)
+            dq.push_back(Tracked(i));
+        BlockDeque<Tracked, 8> copy(dq);
+        int before = Tracked::copies;
+        for (int i = 0; i < 12; ++i)
+            copy.pop_front();
+        copy.pop_back();
+        CHECK(Tracked::copies == before);
+        CHECK(values(copy) == std::vector<int>{12, 13, 14});
+        CHECK(dq.size() == 16);
+        CHECK(dq.front().v == 0);
+
+        // Once the original is gone, the copy owns the blocks and trims the
+        // elements it had popped before writing.
+        dq.clear();
+        copy.push_back(Tracked(99));
+        CHECK(values(copy) == std::vector<int>{12, 13, 14, 99});
+        CHECK(Tracked::live == 4);
+    }
+    CHECK(Tracked::live == 0);
+}
+
+TEST_CASE("Block_copies_in_different_threads")
+{
+    // Each thread reads, pops, pushes and writes through its own copy of
+    // shared blocks; run under TSan to check the ownership handoff.
+    for (int round = 0; round < 20; ++round) {
+        BlockDeque<std::string, 4> dq;
+        for (int i = 0; i < 64; ++i)
+            dq.push_back(std::to_string(i));
+        BlockDeque<std::string, 4> copy(dq);
+
+        auto work = [](BlockDeque<std::string, 4> &mine, std::string tag) {
+            size_t total = 0;
+            for (int i = 0; i < 64; ++i) {
+                total += mine.front().size();
+                mine.pop_front();
+                mine.push_back(tag);
+                mine.back() += "!";
+            }
+            return total;
+        };
+
+        size_t a = 0, b = 0;
+        std::thread other([&] { a = work(dq, "a"); });
+        b = work(copy, "b");
+        other.join();
+
+        CHECK(a == b);
+        CHECK(dq.size() == 64);
+        CHECK(copy.size() == 64);
+        CHECK(dq.front() == "a!");
+        CHECK(copy.back() == "b!");
+    }
+}
@@ -0,0 +1,224 @@
+#include "BlockingDeque.hxx"
+
+#include <catch.hxx>
+
+#include <chrono>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+TEST_CASE("New_is_empty")
+{
+    BlockingDeque<int> dq(4);
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.capacity() == 4);
+    CHECK_FALSE(dq.closed());
+}
+
+TEST_CASE("Zero_capacity_means_one")
+{
+    BlockingDeque<int> dq(0);
+    CHECK(dq.capacity() == 1);
+}
+
+TEST_CASE("Push_pop_is_fifo")
+{
+    BlockingDeque<int> dq(4);
+    CHECK(dq.push_back(5));
+    CHECK(dq.push_back(6));
+    CHECK(dq.push_back(7));
+    CHECK(dq.size() == 3);
+
+    int x = 0;
+    CHECK(dq.pop_front(x));
+    CHECK(x == 5);
+    CHECK(dq.pop_front(x));
+    CHECK(x == 6);
+    CHECK(dq.pop_front(x));
+    CHECK(x == 7);
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Try_push_fails_when_full")
+{
+    BlockingDeque<int> dq(2);
+    CHECK(dq.try_push_back(5));
+    CHECK(dq.try_push_back(6));
+    CHECK_FALSE(dq.try_push_back(7));
+    CHECK(dq.size() == 2);
+}
+
+TEST_CASE("Try_pop_fails_when_empty")
+{
+    BlockingDeque<int> dq(2);
+    int x = 3;
+    CHECK_FALSE(dq.try_pop_front(x));
+    CHECK(x == 3);
+}
+
+TEST_CASE("Timed_push_times_out_when_full")
+{
+    BlockingDeque<int> dq(1);
+    CHECK(dq.push_back(5));
+    CHECK_FALSE(dq.push_back_for(6, std::chrono::milliseconds(10)));
+    CHECK(dq.size() == 1);
+}
+
+TEST_CASE("Timed_pop_times_out_when_empty")
+{
+    BlockingDeque<int> dq(1);
+    int x = 0;
+    CHECK_FALSE(dq.pop_front_for(x, std::chrono::milliseconds(10)));
+    CHECK(dq.push_back_for(5, std::chrono::milliseconds(10)));
+    CHECK(dq.pop_front_for(x, std::chrono::milliseconds(10)));
+    CHECK(x == 5);
+}
+
+TEST_CASE("Close_rejects_pushes_but_drains")
+{
+    BlockingDeque<int> dq(4);
+    dq.push_back(5);
+    dq.push_back(6);
+    dq.close();
+    CHECK(dq.closed());
+    CHECK_FALSE(dq.push_back(7));
+    CHECK_FALSE(dq.try_push_back(7));
+
+    int x = 0;
+    CHECK(dq.pop_front(x));
+    CHECK(x == 5);
+    CHECK(dq.pop_front(x));
+    CHECK(x == 6);
+    CHECK_FALSE(dq.pop_front(x));
+}
+
+TEST_CASE("Close_wakes_blocked_consumer")
+{
+    BlockingDeque<int> dq(4);
+    bool result = true;
+    std::thread consumer([&] {
+        int x;
+        result = dq.pop_front(x);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    dq.close();
+    consumer.join();
+    CHECK_FALSE(result);
+}
+
+TEST_CASE("Close_wakes_blocked_producer")
+{
+    BlockingDeque<int> dq(1);
+    dq.push_back(5);
+    bool result = true;
+    std::thread producer([&] { result = dq.push_back(6); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    dq.close();
+    producer.join();
+    CHECK_FALSE(result);
+}
+
+TEST_CASE("Producers_and_consumers_exchange_everything")
+{
+    const int per_producer = 5000;
+    BlockingDeque<int> dq(8);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 3; ++p) {
+        producers.emplace_back([&dq, p] {
+            for (int i = 0; i < per_producer; ++i)
+                dq.push_back(p * per_producer + i);
+        });
+    }
+
+    std::vector<long> sums(2, 0);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 2; ++c) {
+        consumers.emplace_back([&dq, &sums, c] {
+            int x;
+            while (dq.pop_front(x))
+                sums[c] += x;
+        });
+    }
+
+    for (auto &t : producers)
+        t.join();
+    dq.close();
+    for (auto &t : consumers)
+        t.join();
+
+    long n = 3 * per_producer;
+    CHECK(sums[0] + sums[1] == n * (n - 1) / 2);
+}
+
+TEST_CASE("Try_push_bulk_pushes_what_fits")
+{
+    BlockingDeque<int> dq(3);
+    std::vector<int> in{1, 2, 3, 4, 5};
+    CHECK(dq.try_push_back_bulk(in.begin(), in.end()) == 3);
+    CHECK(dq.size() == 3);
+    CHECK(dq.try_push_back_bulk(in.begin(), in.end()) == 0);
+}
+
+TEST_CASE("Try_pop_bulk_pops_what_is_there")
+{
+    BlockingDeque<int> dq(8);
+    std::vector<int> in{1, 2, 3, 4, 5};
+    dq.try_push_back_bulk(in.begin(), in.end());
+
+    std::vector<int> out;
+    CHECK(dq.try_pop_front_bulk(std::back_inserter(out), 3) == 3);
+    CHECK(out == std::vector<int>{1, 2, 3});
+    CHECK(dq.try_pop_front_bulk(std::back_inserter(out), 10) == 2);
+    CHECK(out == std::vector<int>{1, 2, 3, 4, 5});
+    CHECK(dq.try_pop_front_bulk(std::back_inserter(out), 10) == 0);
+}
+
+TEST_CASE("Pop_bulk_after_close_drains_then_fails")
+{
+    BlockingDeque<int> dq(8);
+    std::vector<int> in{1, 2, 3};
+    dq.push_back_bulk(in.begin(), in.end());
+    dq.close();
+
+    int out[8];
+    CHECK(dq.pop_front_bulk(out, 8) == 3);
+    CHECK(out[2] == 3);
+    CHECK(dq.pop_front_bulk(out, 8) == 0);
+    CHECK(dq.push_back_bulk(in.begin(), in.end()) == 0);
+}
+
+TEST_CASE("Bulk_exchange_larger_than_capacity")
+{
+    const int n = 20000;
+    BlockingDeque<int> dq(16);
+
+    std::thread producer([&] {
+        std::vector<int> batch;
+        for (int i = 0; i < n; ++i) {
+            batch.push_back(i);
+            if (batch.size() == 37 || i == n - 1) {
+                dq.push_back_bulk(batch.begin(), batch.end());
+                batch.clear();
+            }
+        }
+        dq.close();
+    });
+
+    std::vector<int> got;
+    int buf[25];
+    size_t k;
+    while ((k = dq.pop_front_bulk(buf, 25)) != 0)
+        got.insert(got.end(), buf, buf + k);
+    producer.join();
+
+    REQUIRE(got.size() == size_t(n));
+    bool in_order = true;
+    for (int i = 0; i < n; ++i)
+        if (got[i] != i)
+            in_order = false;
+    CHECK(in_order);
+}
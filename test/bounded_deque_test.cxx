@@ -0,0 +1,157 @@
+#include "BoundedDeque.hxx"
+
+#include <catch.hxx>
+
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+TEST_CASE("Bounded_new_is_empty")
+{
+    BoundedDeque<int> dq(4);
+    CHECK(dq.empty());
+    CHECK(dq.capacity() == 4);
+    CHECK_FALSE(dq.closed());
+    BoundedDequeStats s = dq.stats();
+    CHECK(s.pushed == 0);
+    CHECK(s.high_water == 0);
+}
+
+TEST_CASE("Bounded_zero_capacity_means_one")
+{
+    BoundedDeque<int> dq(0);
+    CHECK(dq.capacity() == 1);
+}
+
+TEST_CASE("Bounded_unbounded_never_sheds")
+{
+    BoundedDeque<int, overflow::unbounded> dq;
+    for (int i = 0; i < 1000; ++i)
+        CHECK(dq.push_back(i));
+    CHECK(dq.size() == 1000);
+    int x = -1;
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 0);
+    BoundedDequeStats s = dq.stats();
+    CHECK(s.pushed == 1000);
+    CHECK(s.high_water == 1000);
+    CHECK(s.rejected + s.dropped_oldest + s.dropped_newest + s.blocked == 0);
+}
+
+TEST_CASE("Bounded_reject_fails_when_full")
+{
+    BoundedDeque<int, overflow::reject> dq(2);
+    CHECK(dq.push_back(1));
+    CHECK(dq.push_back(2));
+    CHECK_FALSE(dq.push_back(3));
+    CHECK_FALSE(dq.push_back(4));
+
+    int x = 0;
+    CHECK(dq.pop_front(x));
+    CHECK(x == 1);
+    CHECK(dq.push_back(5));
+    BoundedDequeStats s = dq.stats();
+    CHECK(s.pushed == 3);
+    CHECK(s.rejected == 2);
+    CHECK(s.high_water == 2);
+}
+
+TEST_CASE("Bounded_drop_oldest_keeps_latest")
+{
+    BoundedDeque<int, overflow::drop_oldest> dq(3);
+    for (int i = 0; i < 10; ++i)
+        CHECK(dq.push_back(i));
+    CHECK(dq.size() == 3);
+
+    int x = 0;
+    for (int i = 7; i < 10; ++i) {
+        CHECK(dq.try_pop_front(x));
+        CHECK(x == i);
+    }
+    BoundedDequeStats s = dq.stats();
+    CHECK(s.pushed == 10);
+    CHECK(s.dropped_oldest == 7);
+    CHECK(s.high_water == 3);
+}
+
+TEST_CASE("Bounded_drop_newest_keeps_earliest")
+{
+    BoundedDeque<int, overflow::drop_newest> dq(3);
+    for (int i = 0; i < 10; ++i)
+        CHECK(dq.push_back(i));
+    CHECK(dq.size() == 3);
+
+    int x = 0;
+    for (int i = 0; i < 3; ++i) {
+        CHECK(dq.try_pop_front(x));
+        CHECK(x == i);
+    }
+    BoundedDequeStats s = dq.stats();
+    CHECK(s.pushed == 10);
+    CHECK(s.dropped_newest == 7);
+}
+
+TEST_CASE("Bounded_block_waits_for_room")
+{
+    BoundedDeque<int, overflow::block> dq(1);
+    CHECK(dq.push_back(1));
+    bool result = false;
+    std::thread producer([&] { result = dq.push_back(2); });
+    // `blocked` is counted under the lock just before the producer waits,
+    // so once it shows up the producer is waiting for room.
+    while (dq.stats().blocked == 0)
+        std::this_thread::yield();
+
+    int x = 0;
+    CHECK(dq.pop_front(x));
+    CHECK(x == 1);
+    producer.join();
+    CHECK(result);
+    CHECK(dq.pop_front(x));
+    CHECK(x == 2);
+    CHECK(dq.stats().blocked == 1);
+}
+
+TEST_CASE("Bounded_close_wakes_blocked_producer")
+{
+    BoundedDeque<int, overflow::block> dq(1);
+    dq.push_back(1);
+    bool result = true;
+    std::thread producer([&] { result = dq.push_back(2); });
+    while (dq.stats().blocked == 0)
+        std::this_thread::yield();
+    dq.close();
+    producer.join();
+    CHECK_FALSE(result);
+    CHECK_FALSE(dq.push_back(3));
+
+    int x = 0;
+    CHECK(dq.pop_front(x));
+    CHECK(x == 1);
+    CHECK_FALSE(dq.pop_front(x));
+}
+
+TEST_CASE("Bounded_block_exchanges_everything")
+{
+    const int n = 20000;
+    BoundedDeque<int, overflow::block> dq(8);
+    std::thread producer([&] {
+        for (int i = 0; i < n; ++i)
+            dq.push_back(i);
+        dq.close();
+    });
+
+    long sum = 0;
+    int expected = 0;
+    bool in_order = true;
+    int x;
+    while (dq.pop_front(x)) {
+        in_order = in_order && x == expected++;
+        sum += x;
+    }
+    producer.join();
+    CHECK(in_order);
+    CHECK(sum == long(n) * (n - 1) / 2);
+    CHECK(dq.stats().high_water <= 8);
+}
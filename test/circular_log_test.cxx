@@ -0,0 +1,124 @@
+#include "CircularLog.hxx"
+
+#include <catch.hxx>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    // An event whose halves must agree, so a torn copy is detectable.
+    struct Event {
+        uint64_t seq;
+        uint64_t check;
+    };
+
+    Event event(uint64_t seq)
+    {
+        return Event{seq, ~seq};
+    }
+}
+
+TEST_CASE("CircularLog_new_is_empty")
+{
+    CircularLog<int, 4> log;
+    CHECK(log.empty());
+    CHECK(!log.full());
+    CHECK(log.size() == 0);
+    CHECK(log.dropped() == 0);
+    int out[4];
+    CHECK(log.snapshot(out, 4) == 0);
+    log.pop_front();
+    CHECK(log.empty());
+}
+
+TEST_CASE("CircularLog_overwrites_oldest")
+{
+    CircularLog<int, 4> log;
+    for (int i = 0; i < 4; ++i)
+        log.push_back(i);
+    CHECK(log.full());
+    CHECK(log.dropped() == 0);
+    CHECK(log.front() == 0);
+    CHECK(log.back() == 3);
+
+    for (int i = 4; i < 10; ++i)
+        log.push_back(i);
+    CHECK(log.size() == 4);
+    CHECK(log.dropped() == 6);
+    CHECK(log.front() == 6);
+    CHECK(log.back() == 9);
+}
+
+TEST_CASE("CircularLog_pop_and_clear")
+{
+    CircularLog<int, 3> log;
+    log.push_back(1);
+    log.push_back(2);
+    log.pop_front();
+    CHECK(log.size() == 1);
+    CHECK(log.front() == 2);
+    log.push_back(3);
+    log.push_back(4);
+    CHECK(log.full());
+    CHECK(log.dropped() == 0);
+    log.clear();
+    CHECK(log.empty());
+    log.push_back(5);
+    CHECK(log.front() == 5);
+    CHECK(log.back() == 5);
+}
+
+TEST_CASE("CircularLog_snapshot_takes_most_recent")
+{
+    CircularLog<int, 8> log;
+    for (int i = 0; i < 20; ++i)
+        log.push_back(i);
+    log.pop_front();
+
+    int out[8];
+    REQUIRE(log.snapshot(out, 8) == 7);
+    for (int i = 0; i < 7; ++i)
+        CHECK(out[i] == 13 + i);
+
+    REQUIRE(log.snapshot(out, 3) == 3);
+    CHECK(out[0] == 17);
+    CHECK(out[2] == 19);
+}
+
+TEST_CASE("CircularLog_snapshot_races_writer")
+{
+    const uint64_t n = 200000;
+    CircularLog<Event, 64> log;
+    std::atomic<bool> done(false);
+    std::atomic<bool> ok(true);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            Event out[64];
+            while (!done.load()) {
+                size_t count = log.snapshot(out, 64);
+                for (size_t i = 0; i < count; ++i) {
+                    if (out[i].check != ~out[i].seq)
+                        ok = false;
+                    if (i > 0 && out[i].seq != out[i - 1].seq + 1)
+                        ok = false;
+                }
+            }
+        });
+    }
+
+    for (uint64_t i = 0; i < n; ++i)
+        log.push_back(event(i));
+    done = true;
+    for (auto &t : readers)
+        t.join();
+
+    CHECK(ok.load());
+    CHECK(log.dropped() == n - 64);
+    CHECK(log.front().seq == n - 64);
+}
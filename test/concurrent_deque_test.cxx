@@ -0,0 +1,224 @@
+#include "ConcurrentDeque.hxx"
+
+#include <catch.hxx>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+TEST_CASE("New_is_empty")
+{
+    ConcurrentDeque<int> dq;
+    CHECK(dq.empty());
+    int x = 3;
+    CHECK_FALSE(dq.try_pop_front(x));
+    CHECK(x == 3);
+}
+
+TEST_CASE("Push_back_pop_front_is_fifo")
+{
+    ConcurrentDeque<int> dq;
+    dq.push_back(5);
+    dq.push_back(6);
+    dq.push_back(7);
+    CHECK_FALSE(dq.empty());
+
+    int x = 0;
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 5);
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 6);
+    dq.push_back(8);
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 7);
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 8);
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Non_trivial_elements")
+{
+    ConcurrentDeque<std::string> dq;
+    dq.push_back("hello");
+    dq.push_back(std::string(100, 'x'));
+
+    std::string s;
+    CHECK(dq.try_pop_front(s));
+    CHECK(s == "hello");
+}
+
+TEST_CASE("Producers_and_consumers_exchange_each_element_once")
+{
+    const int producers = 3, consumers = 3, per_producer = 20000;
+    ConcurrentDeque<int> dq;
+    std::vector<std::atomic<int>> seen(producers * per_producer);
+    for (auto &s : seen)
+        s.store(0);
+
+    std::atomic<int> popped(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&dq, p] {
+            for (int i = 0; i < per_producer; ++i)
+                dq.push_back(p * per_producer + i);
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            int x;
+            while (popped.load() < producers * per_producer) {
+                if (dq.try_pop_front(x)) {
+                    seen[x].fetch_add(1);
+                    popped.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    int wrong = 0;
+    for (auto &s : seen)
+        if (s.load() != 1)
+            ++wrong;
+    CHECK(wrong == 0);
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Per_producer_order_is_preserved")
+{
+    const int per_producer = 20000;
+    ConcurrentDeque<int> dq;
+
+    std::thread a([&] {
+        for (int i = 0; i < per_producer; ++i)
+            dq.push_back(i);
+    });
+    std::thread b([&] {
+        for (int i = 0; i < per_producer; ++i)
+            dq.push_back(per_producer + i);
+    });
+
+    int last_a = -1, last_b = -1, got = 0;
+    bool ordered = true;
+    int x;
+    while (got < 2 * per_producer) {
+        if (!dq.try_pop_front(x))
+            continue;
+        ++got;
+        int &last = x < per_producer ? last_a : last_b;
+        if (x <= last)
+            ordered = false;
+        last = x;
+    }
+    a.join();
+    b.join();
+    CHECK(ordered);
+}
+
+TEST_CASE("Popped_nodes_are_reclaimed")
+{
+    EpochDomain &domain = EpochDomain::instance();
+    ConcurrentDeque<int> dq;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            int x;
+            for (int i = 0; i < 5000; ++i) {
+                dq.push_back(i);
+                dq.try_pop_front(x);
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    for (int i = 0; i < 10 && domain.pending() != 0; ++i)
+        domain.collect();
+    CHECK(domain.pending() == 0);
+}
+
+TEST_CASE("Hazard_push_back_pop_front_is_fifo")
+{
+    ConcurrentDeque<int, HazardReclaim> dq;
+    dq.push_back(5);
+    dq.push_back(6);
+    CHECK_FALSE(dq.empty());
+
+    int x = 0;
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 5);
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 6);
+    CHECK_FALSE(dq.try_pop_front(x));
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Hazard_producers_and_consumers_exchange_each_element_once")
+{
+    const int producers = 3, consumers = 3, per_producer = 20000;
+    ConcurrentDeque<int, HazardReclaim> dq;
+    std::vector<std::atomic<int>> seen(producers * per_producer);
+    for (auto &s : seen)
+        s.store(0);
+
+    std::atomic<int> popped(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&dq, p] {
+            for (int i = 0; i < per_producer; ++i)
+                dq.push_back(p * per_producer + i);
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            int x;
+            while (popped.load() < producers * per_producer) {
+                if (dq.try_pop_front(x)) {
+                    seen[x].fetch_add(1);
+                    popped.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    int wrong = 0;
+    for (auto &s : seen)
+        if (s.load() != 1)
+            ++wrong;
+    CHECK(wrong == 0);
+}
+
+TEST_CASE("Hazard_retired_nodes_stay_bounded_under_churn")
+{
+    HazardDomain &domain = HazardDomain::instance();
+    ConcurrentDeque<int, HazardReclaim> dq;
+    std::atomic<size_t> peak(0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            int x;
+            for (int i = 0; i < 5000; ++i) {
+                dq.push_back(i);
+                dq.try_pop_front(x);
+                size_t p = domain.pending();
+                size_t old = peak.load();
+                while (p > old && !peak.compare_exchange_weak(old, p)) {}
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    // Every thread's list stays below the threshold, whatever the others do.
+    CHECK(peak.load() <= 5 * domain.threshold());
+    domain.collect();
+    CHECK(domain.pending() == 0);
+}
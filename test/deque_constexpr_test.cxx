@@ -0,0 +1,99 @@
+#include "Deque.hxx"
+
+#include <catch.hxx>
+
+#include <array>
+
+using namespace ipd;
+
+namespace {
+
+    constexpr int push_pop_sum()
+    {
+        Deque<int> dq;
+        for (int i = 1; i <= 4; ++i) {
+            dq.push_back(i);
+            dq.push_front(-i);
+        }
+        dq.pop_front();
+        dq.pop_back();
+        int sum = 0;
+        for (int x : dq)
+            sum += x;
+        return sum;
+    }
+
+    constexpr size_t copied_size()
+    {
+        Deque<int> dq{1, 2, 3};
+        Deque<int> copy(dq);
+        copy.push_back(4);
+        dq = copy;
+        dq.clear();
+        return copy.size() + dq.size();
+    }
+
+    constexpr int reverse_walk()
+    {
+        Deque<int> dq{1, 2, 3};
+        int result = 0;
+        for (auto it = dq.end(); it != dq.begin();) {
+            --it;
+            result = result * 10 + *it;
+        }
+        return result;
+    }
+
+    // Shortest number of moves from square 0 to every square of a 4x4
+    // board, for a knight-like piece that moves (+1, +2) or (+2, +1) in
+    // any sign combination; -1 marks unreachable squares.
+    constexpr std::array<int, 16> distance_table()
+    {
+        std::array<int, 16> dist{};
+        for (int &d : dist)
+            d = -1;
+
+        Deque<int> frontier;
+        dist[0] = 0;
+        frontier.push_back(0);
+        constexpr int moves[8][2] = {{1, 2}, {2, 1}, {-1, 2}, {-2, 1},
+                                     {1, -2}, {2, -1}, {-1, -2}, {-2, -1}};
+        while (!frontier.empty()) {
+            int square = frontier.front();
+            frontier.pop_front();
+            int row = square / 4, col = square % 4;
+            for (const auto &m : moves) {
+                int r = row + m[0], c = col + m[1];
+                if (r < 0 || r >= 4 || c < 0 || c >= 4)
+                    continue;
+                int next = r * 4 + c;
+                if (dist[next] >= 0)
+                    continue;
+                dist[next] = dist[square] + 1;
+                frontier.push_back(next);
+            }
+        }
+        return dist;
+    }
+
+    constexpr std::array<int, 16> table = distance_table();
+}
+
+static_assert(push_pop_sum() == (2 + 3 + 4) - (2 + 3 + 4) + 1 - 1,
+              "push/pop in constant evaluation");
+static_assert(copied_size() == 4, "copy and assignment in constant evaluation");
+static_assert(reverse_walk() == 321, "reverse iteration in constant evaluation");
+static_assert(table[0] == 0, "start square");
+static_assert(table[6] == 1, "one move to (1, 2)");
+static_assert(table[5] == 4, "four moves to (1, 1)");
+
+TEST_CASE("Compile_time_table_matches_runtime_bfs")
+{
+    CHECK(table == distance_table());
+}
+
+TEST_CASE("Constexpr_deque_works_at_runtime")
+{
+    CHECK(push_pop_sum() == 0);
+    CHECK(reverse_walk() == 321);
+}
@@ -319,3 +319,65 @@ TEST_CASE("Splice Non-Empty/Non-Empty")
     CHECK(dq1.size() == 0);
 }
 
+
+TEST_CASE("Iterate_front_to_back")
+{
+    Deque<int> dq{3, 4, 5};
+    int expected = 3;
+    for (int x : dq)
+        CHECK(x == expected++);
+    CHECK(expected == 6);
+}
+
+TEST_CASE("Iterate_back_to_front_from_end")
+{
+    const Deque<int> dq{3, 4, 5};
+    Deque<int>::const_iterator it = dq.end();
+    CHECK(*--it == 5);
+    CHECK(*--it == 4);
+    CHECK(*--it == 3);
+    CHECK(it == dq.begin());
+}
+
+TEST_CASE("Iterator_writes_through")
+{
+    Deque<int> dq{1, 2, 3};
+    for (int &x : dq)
+        x *= 10;
+    CHECK(dq.front() == 10);
+    CHECK(dq.back() == 30);
+}
+
+TEST_CASE("Empty_begin_is_end")
+{
+    Deque<int> dq;
+    CHECK(dq.begin() == dq.end());
+}
+
+TEST_CASE("Self_assignment_keeps_elements")
+{
+    Deque<int> dq{1, 2};
+    Deque<int> &alias = dq;
+    dq = alias;
+    CHECK(dq.size() == 2);
+    CHECK(dq.front() == 1);
+    CHECK(dq.back() == 2);
+}
+
+TEST_CASE("Swap_exchanges_contents")
+{
+    Deque<int> a{1, 2, 3};
+    Deque<int> b{4};
+    a.swap(b);
+    CHECK(a.size() == 1);
+    CHECK(a.front() == 4);
+    CHECK(b.size() == 3);
+    CHECK(b.front() == 1);
+    CHECK(b.back() == 3);
+    CHECK(*--b.end() == 3);
+
+    Deque<int> empty;
+    empty.swap(b);
+    CHECK(b.empty());
+    CHECK(empty.size() == 3);
+}
@@ -0,0 +1,136 @@
+#include "EpochDomain.hxx"
+
+#include <catch.hxx>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    std::atomic<int> freed(0);
+
+    void count_free(void *p)
+    {
+        delete static_cast<int *>(p);
+        freed.fetch_add(1);
+    }
+
+    // Calls collect() until the domain has nothing left to free.
+    void drain(EpochDomain &domain)
+    {
+        for (int i = 0; i < 10 && domain.pending() != 0; ++i)
+            domain.collect();
+    }
+}
+
+TEST_CASE("Retired_object_is_eventually_freed")
+{
+    EpochDomain &domain = EpochDomain::instance();
+    drain(domain);
+    freed.store(0);
+
+    {
+        EpochDomain::Guard guard;
+        domain.retire(new int(5), count_free);
+    }
+    CHECK(domain.pending() == 1);
+    drain(domain);
+    CHECK(domain.pending() == 0);
+    CHECK(freed.load() == 1);
+}
+
+TEST_CASE("Typed_retire_deletes")
+{
+    EpochDomain &domain = EpochDomain::instance();
+    domain.retire(new std::vector<int>(100));
+    drain(domain);
+    CHECK(domain.pending() == 0);
+}
+
+TEST_CASE("Pinned_thread_holds_back_reclamation")
+{
+    EpochDomain &domain = EpochDomain::instance();
+    drain(domain);
+    freed.store(0);
+
+    std::atomic<int> stage(0);
+    std::thread reader([&] {
+        EpochDomain::Guard guard;
+        stage.store(1);
+        while (stage.load() != 2)
+            std::this_thread::yield();
+    });
+    while (stage.load() != 1)
+        std::this_thread::yield();
+
+    domain.retire(new int(5), count_free);
+    for (int i = 0; i < 10; ++i)
+        domain.collect();
+    CHECK(freed.load() == 0);
+
+    stage.store(2);
+    reader.join();
+    drain(domain);
+    CHECK(freed.load() == 1);
+}
+
+TEST_CASE("Guards_nest")
+{
+    EpochDomain &domain = EpochDomain::instance();
+    drain(domain);
+    freed.store(0);
+
+    {
+        EpochDomain::Guard outer;
+        {
+            EpochDomain::Guard inner;
+        }
+        // Still pinned by `outer`: the epoch can move at most one step.
+        uint64_t e = domain.epoch();
+        domain.retire(new int(5), count_free);
+        for (int i = 0; i < 10; ++i)
+            domain.collect();
+        CHECK(domain.epoch() <= e + 1);
+        CHECK(freed.load() == 0);
+    }
+    drain(domain);
+    CHECK(freed.load() == 1);
+}
+
+TEST_CASE("Pending_stays_bounded_under_churn")
+{
+    EpochDomain &domain = EpochDomain::instance();
+    drain(domain);
+
+    size_t peak = 0;
+    for (int i = 0; i < 20000; ++i) {
+        EpochDomain::Guard guard;
+        domain.retire(new int(i));
+        if (domain.pending() > peak)
+            peak = domain.pending();
+    }
+    CHECK(peak <= 3 * size_t(EpochDomain::collect_interval));
+}
+
+TEST_CASE("Exited_threads_retirements_are_reclaimed")
+{
+    EpochDomain &domain = EpochDomain::instance();
+    drain(domain);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < 5000; ++i) {
+                EpochDomain::Guard guard;
+                domain.retire(new int(i));
+            }
+        });
+    }
+    for (auto &w : workers)
+        w.join();
+
+    drain(domain);
+    CHECK(domain.pending() == 0);
+}
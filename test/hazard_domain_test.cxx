@@ -0,0 +1,135 @@
+#include "HazardDomain.hxx"
+
+#include <catch.hxx>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    std::atomic<int> freed(0);
+
+    void count_free(void *p)
+    {
+        delete static_cast<int *>(p);
+        freed.fetch_add(1);
+    }
+}
+
+TEST_CASE("Unprotected_object_is_freed_by_collect")
+{
+    HazardDomain &domain = HazardDomain::instance();
+    domain.collect();
+    freed.store(0);
+
+    domain.retire(new int(5), count_free);
+    CHECK(domain.pending() == 1);
+    domain.collect();
+    CHECK(domain.pending() == 0);
+    CHECK(freed.load() == 1);
+}
+
+TEST_CASE("Protect_returns_current_value")
+{
+    int a = 1;
+    std::atomic<int *> src(&a);
+    HazardDomain::Guard guard;
+    CHECK(guard.protect(0, src) == &a);
+}
+
+TEST_CASE("Protected_object_survives_collect")
+{
+    HazardDomain &domain = HazardDomain::instance();
+    domain.collect();
+    freed.store(0);
+
+    std::atomic<int *> src(new int(5));
+    std::atomic<int> stage(0);
+    std::thread reader([&] {
+        HazardDomain::Guard guard;
+        int *p = guard.protect(0, src);
+        stage.store(1);
+        while (stage.load() != 2)
+            std::this_thread::yield();
+        CHECK(*p == 5);
+    });
+    while (stage.load() != 1)
+        std::this_thread::yield();
+
+    int *old = src.exchange(nullptr);
+    domain.retire(old, count_free);
+    domain.collect();
+    CHECK(freed.load() == 0);
+
+    stage.store(2);
+    reader.join();
+    domain.collect();
+    CHECK(freed.load() == 1);
+}
+
+TEST_CASE("Reset_releases_protection")
+{
+    HazardDomain &domain = HazardDomain::instance();
+    domain.collect();
+    freed.store(0);
+
+    std::atomic<int *> src(new int(5));
+    HazardDomain::Guard guard;
+    guard.protect(1, src);
+    domain.retire(src.exchange(nullptr), count_free);
+    domain.collect();
+    CHECK(freed.load() == 0);
+
+    guard.reset(1);
+    domain.collect();
+    CHECK(freed.load() == 1);
+}
+
+TEST_CASE("Retire_list_stays_below_threshold")
+{
+    HazardDomain &domain = HazardDomain::instance();
+    domain.collect();
+
+    size_t peak = 0;
+    for (int i = 0; i < 20000; ++i) {
+        domain.retire(new int(i));
+        if (domain.pending() > peak)
+            peak = domain.pending();
+    }
+    CHECK(peak <= domain.threshold());
+}
+
+TEST_CASE("Stalled_reader_does_not_hold_back_others")
+{
+    HazardDomain &domain = HazardDomain::instance();
+    domain.collect();
+
+    std::atomic<int *> src(new int(0));
+    std::atomic<int> stage(0);
+    std::thread reader([&] {
+        HazardDomain::Guard guard;
+        guard.protect(0, src);
+        stage.store(1);
+        while (stage.load() != 2)
+            std::this_thread::yield();
+    });
+    while (stage.load() != 1)
+        std::this_thread::yield();
+
+    // The reader pins one node; everything else must still be freed.
+    domain.retire(src.exchange(nullptr));
+    size_t peak = 0;
+    for (int i = 0; i < 20000; ++i) {
+        domain.retire(new int(i));
+        if (domain.pending() > peak)
+            peak = domain.pending();
+    }
+    CHECK(peak <= domain.threshold());
+
+    stage.store(2);
+    reader.join();
+    domain.collect();
+    CHECK(domain.pending() == 0);
+}
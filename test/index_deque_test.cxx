@@ -0,0 +1,197 @@
+#include "IndexDeque.hxx"
+
+#include <catch.hxx>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    template<typename T>
+    std::vector<T> contents(const IndexDeque<T> &dq)
+    {
+        return std::vector<T>(dq.begin(), dq.end());
+    }
+}
+
+TEST_CASE("Index_new_is_empty")
+{
+    IndexDeque<int> dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.capacity() == 0);
+    CHECK(dq.begin() == dq.end());
+}
+
+TEST_CASE("Index_push_and_pop_both_ends")
+{
+    IndexDeque<int> dq;
+    dq.push_back(2);
+    dq.push_front(1);
+    dq.push_back(3);
+    CHECK(contents(dq) == std::vector<int>{1, 2, 3});
+    dq.pop_front();
+    CHECK(dq.front() == 2);
+    dq.pop_back();
+    CHECK(dq.back() == 2);
+    dq.pop_back();
+    CHECK(dq.empty());
+    dq.pop_front();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Index_sequential_pushes_are_adjacent")
+{
+    IndexDeque<int> dq;
+    for (int i = 0; i < 100; ++i)
+        dq.push_back(i);
+    const int *first = &dq.front();
+    int i = 0;
+    for (const int &x : dq)
+        CHECK(&x - first == 3 * i++);  // 12-byte slots
+}
+
+TEST_CASE("Index_reuses_freed_slots")
+{
+    IndexDeque<int> dq;
+    for (int i = 0; i < 8; ++i)
+        dq.push_back(i);
+    size_t cap = dq.capacity();
+    for (int round = 0; round < 1000; ++round) {
+        dq.pop_front();
+        dq.push_back(round);
+    }
+    CHECK(dq.capacity() == cap);
+    CHECK(dq.size() == 8);
+    CHECK(dq.back() == 999);
+}
+
+TEST_CASE("Index_growth_moves_nontrivial_elements")
+{
+    IndexDeque<std::string> dq;
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 2)
+            dq.push_back(std::to_string(i) + " padding past the small buffer");
+        else
+            dq.push_front(std::to_string(i) + " padding past the small buffer");
+    }
+    CHECK(dq.size() == 1000);
+    CHECK(dq.front() == "998 padding past the small buffer");
+    CHECK(dq.back() == "999 padding past the small buffer");
+    dq.clear();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Index_iterate_backwards")
+{
+    IndexDeque<int> dq{1, 2, 3};
+    std::vector<int> seen;
+    for (auto it = dq.end(); it != dq.begin();)
+        seen.push_back(*--it);
+    CHECK(seen == std::vector<int>{3, 2, 1});
+}
+
+TEST_CASE("Index_copy_assign_splice")
+{
+    IndexDeque<int> dq{1, 2, 3};
+    IndexDeque<int> copy(dq);
+    dq.pop_front();
+    CHECK(contents(copy) == std::vector<int>{1, 2, 3});
+    copy = dq;
+    CHECK(contents(copy) == std::vector<int>{2, 3});
+    IndexDeque<int> &alias = copy;
+    copy = alias;
+    CHECK(copy.size() == 2);
+    dq.splice(copy);
+    CHECK(copy.empty());
+    CHECK(contents(dq) == std::vector<int>{2, 3, 2, 3});
+}
+
+TEST_CASE("Index_write_then_read_round_trips")
+{
+    IndexDeque<int> dq;
+    for (int i = 0; i < 50; ++i)
+        dq.push_back(i);
+    for (int i = 0; i < 10; ++i) {
+        dq.pop_front();
+        dq.push_front(-i);
+    }
+    dq.pop_back();
+
+    std::stringstream buf;
+    REQUIRE(dq.write(buf));
+    IndexDeque<int> loaded{7, 8};
+    REQUIRE(loaded.read(buf));
+    CHECK(contents(loaded) == contents(dq));
+
+    // The free stack survives too.
+    loaded.push_back(100);
+    loaded.push_front(-100);
+    CHECK(loaded.back() == 100);
+    CHECK(loaded.front() == -100);
+}
+
+TEST_CASE("Index_read_rejects_garbage")
+{
+    std::stringstream buf("definitely not a deque, but long enough for a header");
+    IndexDeque<int> dq{1};
+    CHECK_FALSE(dq.read(buf));
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Index_read_rejects_truncated_input")
+{
+    IndexDeque<int> dq{1, 2, 3};
+    std::stringstream buf;
+    REQUIRE(dq.write(buf));
+    std::string bytes = buf.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 4));
+    IndexDeque<int> loaded;
+    CHECK_FALSE(loaded.read(truncated));
+    CHECK(loaded.empty());
+}
+
+namespace {
+    // Overwrites the 32-bit header field at `offset` of a written deque.
+    std::string patch(const std::string &bytes, size_t offset, uint32_t value)
+    {
+        std::string result = bytes;
+        std::memcpy(&result[offset], &value, sizeof value);
+        return result;
+    }
+}
+
+TEST_CASE("Index_read_rejects_huge_slot_count")
+{
+    IndexDeque<int> dq{1, 2, 3};
+    std::stringstream buf;
+    REQUIRE(dq.write(buf));
+
+    // The `used` field, claiming far more slots than the stream holds.
+    for (uint32_t used : {uint32_t(100000000), uint32_t(0xfffffffe), uint32_t(0xffffffff)}) {
+        std::stringstream corrupt(patch(buf.str(), 20, used));
+        IndexDeque<int> loaded;
+        CHECK_FALSE(loaded.read(corrupt));
+        CHECK(loaded.empty());
+        loaded.push_back(4);
+        CHECK(loaded.front() == 4);
+    }
+}
+
+TEST_CASE("Index_read_rejects_free_list_into_live_slots")
+{
+    IndexDeque<int> dq{1, 2, 3};
+    dq.pop_back();
+    std::stringstream buf;
+    REQUIRE(dq.write(buf));
+
+    // Point the free stack (the `free_top` field) at the live tail slot.
+    std::stringstream corrupt(patch(buf.str(), 32, 1));
+    IndexDeque<int> loaded;
+    CHECK_FALSE(loaded.read(corrupt));
+    CHECK(loaded.empty());
+}
@@ -0,0 +1,168 @@
+#include "IntrusiveDeque.hxx"
+
+#include <catch.hxx>
+
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+
+    struct Timer {
+        explicit Timer(int id) : id(id) {}
+
+        int id;
+        IntrusiveHook hook;
+    };
+
+    // The hook is not the first member, and there are two of them.
+    struct Connection {
+        explicit Connection(int id) : id(id) {}
+
+        double weight = 0;
+        int id;
+        IntrusiveHook idle_hook;
+        IntrusiveHook ready_hook;
+    };
+
+    using TimerDeque = IntrusiveDeque<Timer, &Timer::hook>;
+
+    std::vector<int> ids(const TimerDeque &dq)
+    {
+        std::vector<int> result;
+        for (const Timer &t : dq)
+            result.push_back(t.id);
+        return result;
+    }
+}
+
+TEST_CASE("Intrusive_new_is_empty")
+{
+    TimerDeque dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.begin() == dq.end());
+}
+
+TEST_CASE("Intrusive_push_links_the_object_itself")
+{
+    Timer a(1), b(2);
+    TimerDeque dq;
+    dq.push_back(a);
+    dq.push_front(b);
+    CHECK(dq.size() == 2);
+    CHECK(&dq.front() == &b);
+    CHECK(&dq.back() == &a);
+    dq.clear();
+}
+
+TEST_CASE("Intrusive_pops_from_both_ends")
+{
+    Timer a(1), b(2), c(3);
+    TimerDeque dq;
+    dq.push_back(a);
+    dq.push_back(b);
+    dq.push_back(c);
+    dq.pop_front();
+    CHECK(dq.front().id == 2);
+    dq.pop_back();
+    CHECK(dq.back().id == 2);
+    dq.pop_back();
+    CHECK(dq.empty());
+    dq.pop_back();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Intrusive_erase_from_middle")
+{
+    Timer a(1), b(2), c(3);
+    TimerDeque dq;
+    dq.push_back(a);
+    dq.push_back(b);
+    dq.push_back(c);
+    dq.erase(b);
+    CHECK(dq.size() == 2);
+    CHECK(ids(dq) == std::vector<int>{1, 3});
+    dq.erase(a);
+    dq.erase(c);
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Intrusive_erased_object_can_be_relinked")
+{
+    Timer a(1), b(2);
+    TimerDeque dq;
+    dq.push_back(a);
+    dq.push_back(b);
+    dq.erase(a);
+    dq.push_back(a);
+    CHECK(ids(dq) == std::vector<int>{2, 1});
+    dq.clear();
+}
+
+TEST_CASE("Intrusive_iterate_backwards")
+{
+    Timer a(1), b(2), c(3);
+    TimerDeque dq;
+    dq.push_back(a);
+    dq.push_back(b);
+    dq.push_back(c);
+    std::vector<int> seen;
+    for (auto it = dq.end(); it != dq.begin();)
+        seen.push_back((--it)->id);
+    CHECK(seen == std::vector<int>{3, 2, 1});
+    dq.clear();
+}
+
+TEST_CASE("Intrusive_splice_is_constant_time_append")
+{
+    Timer a(1), b(2), c(3);
+    TimerDeque dq1, dq2;
+    dq1.push_back(a);
+    dq2.push_back(b);
+    dq2.push_back(c);
+    dq1.splice(dq2);
+    CHECK(dq2.empty());
+    CHECK(dq1.size() == 3);
+    CHECK(ids(dq1) == std::vector<int>{1, 2, 3});
+    dq2.splice(dq1);
+    CHECK(ids(dq2) == std::vector<int>{1, 2, 3});
+    dq2.clear();
+}
+
+TEST_CASE("Intrusive_object_in_two_deques_via_two_hooks")
+{
+    Connection x(1), y(2);
+    IntrusiveDeque<Connection, &Connection::idle_hook> idle;
+    IntrusiveDeque<Connection, &Connection::ready_hook> ready;
+    idle.push_back(x);
+    idle.push_back(y);
+    ready.push_back(y);
+    CHECK(&ready.front() == &y);
+    CHECK(ready.front().id == 2);
+    CHECK(&idle.back() == &y);
+    idle.erase(y);
+    CHECK(&idle.back() == &x);
+    CHECK(&ready.front() == &y);
+    idle.clear();
+    ready.clear();
+}
+
+#if IPD_INTRUSIVE_SAFE
+TEST_CASE("Intrusive_safe_mode_tracks_linked_state")
+{
+    Timer a(1);
+    CHECK_FALSE(a.hook.is_linked());
+    {
+        TimerDeque dq;
+        dq.push_back(a);
+        CHECK(a.hook.is_linked());
+        Timer copy(a);
+        CHECK_FALSE(copy.hook.is_linked());
+        dq.pop_front();
+        CHECK_FALSE(a.hook.is_linked());
+        dq.push_back(a);
+    }
+    CHECK_FALSE(a.hook.is_linked());
+}
+#endif
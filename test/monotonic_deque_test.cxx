@@ -0,0 +1,118 @@
+#include "MonotonicDeque.hxx"
+
+#include <catch.hxx>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace ipd;
+
+TEST_CASE("Monotonic_new_is_empty")
+{
+    MonotonicDeque<int> window;
+    CHECK(window.empty());
+    CHECK(window.size() == 0);
+    CHECK(window.next_index() == 0);
+}
+
+TEST_CASE("Monotonic_push_returns_sequential_indices")
+{
+    MonotonicDeque<int> window;
+    CHECK(window.push(5) == 0);
+    CHECK(window.push(7) == 1);
+    CHECK(window.next_index() == 2);
+}
+
+TEST_CASE("Monotonic_push_evicts_dominated_values")
+{
+    MonotonicDeque<int> window;
+    window.push(5);
+    window.push(7);
+    window.push(6);
+    CHECK(window.size() == 2);
+    CHECK(window.top() == 5);
+    window.push(3);
+    CHECK(window.size() == 1);
+    CHECK(window.top() == 3);
+    CHECK(window.top_index() == 3);
+}
+
+TEST_CASE("Monotonic_expire_reveals_next_best")
+{
+    MonotonicDeque<int> window;
+    window.push(1);
+    window.push(4);
+    window.push(2);
+    window.expire(1);
+    CHECK(window.top() == 2);
+    window.expire(3);
+    CHECK(window.empty());
+}
+
+TEST_CASE("Monotonic_greater_tracks_maximum")
+{
+    MonotonicDeque<int, std::greater<int>> window;
+    window.push(3);
+    window.push(9);
+    window.push(4);
+    CHECK(window.top() == 9);
+    window.expire(2);
+    CHECK(window.top() == 4);
+}
+
+TEST_CASE("Monotonic_sliding_window_matches_rescan")
+{
+    std::mt19937 rng(11);
+    std::vector<int> values(5000);
+    for (int &v : values)
+        v = int(rng() % 100);
+
+    for (size_t w : {1, 3, 17, 256}) {
+        MonotonicDeque<int> window;
+        for (size_t i = 0; i < values.size(); ++i) {
+            window.push(values[i]);
+            size_t lo = i + 1 >= w ? i + 1 - w : 0;
+            window.expire(lo);
+            int expected = *std::min_element(values.begin() + lo,
+                                             values.begin() + i + 1);
+            REQUIRE(window.top() == expected);
+            REQUIRE(values[window.top_index()] == expected);
+        }
+    }
+}
+
+TEST_CASE("Monotonic_push_n_matches_single_pushes")
+{
+    std::mt19937 rng(5);
+    MonotonicDeque<int> batched, single;
+    for (int round = 0; round < 500; ++round) {
+        std::vector<int> batch(rng() % 20);
+        for (int &v : batch)
+            v = int(rng() % 50);
+        size_t first = batched.push_n(batch.begin(), batch.end());
+        CHECK(first == single.next_index());
+        for (int v : batch)
+            single.push(v);
+        REQUIRE(batched.size() == single.size());
+        REQUIRE(batched.next_index() == single.next_index());
+        if (!single.empty()) {
+            REQUIRE(batched.top() == single.top());
+            REQUIRE(batched.top_index() == single.top_index());
+        }
+        size_t lo = single.next_index() > 40 ? single.next_index() - 40 : 0;
+        batched.expire(lo);
+        single.expire(lo);
+    }
+}
+
+TEST_CASE("Monotonic_clear_keeps_counting")
+{
+    MonotonicDeque<int> window;
+    window.push(1);
+    window.push(2);
+    window.clear();
+    CHECK(window.empty());
+    CHECK(window.push(9) == 2);
+}
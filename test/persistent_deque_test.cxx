@@ -0,0 +1,137 @@
+#include "PersistentDeque.hxx"
+
+#include <catch.hxx>
+
+#include <deque>
+#include <random>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    template<typename T>
+    std::deque<T> contents(PersistentDeque<T> dq)
+    {
+        std::deque<T> result;
+        for (; !dq.empty(); dq = dq.pop_front())
+            result.push_back(dq.front());
+        return result;
+    }
+}
+
+TEST_CASE("Persistent_new_is_empty")
+{
+    PersistentDeque<int> dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.pop_front().empty());
+    CHECK(dq.pop_back().empty());
+}
+
+TEST_CASE("Persistent_push_returns_new_version")
+{
+    PersistentDeque<int> v0;
+    PersistentDeque<int> v1 = v0.push_back(1);
+    PersistentDeque<int> v2 = v1.push_front(0);
+    CHECK(v0.empty());
+    CHECK(v1.size() == 1);
+    CHECK(v1.front() == 1);
+    CHECK(v2.size() == 2);
+    CHECK(v2.front() == 0);
+    CHECK(v2.back() == 1);
+}
+
+TEST_CASE("Persistent_pops_from_both_ends")
+{
+    PersistentDeque<int> dq;
+    for (int i = 0; i < 10; ++i)
+        dq = dq.push_back(i);
+    CHECK(dq.pop_front().front() == 1);
+    CHECK(dq.pop_back().back() == 8);
+    CHECK(dq.front() == 0);
+    CHECK(dq.back() == 9);
+}
+
+TEST_CASE("Persistent_drains_from_the_other_end")
+{
+    PersistentDeque<int> dq;
+    for (int i = 0; i < 100; ++i)
+        dq = dq.push_back(i);
+    for (int i = 99; i >= 0; --i) {
+        REQUIRE(dq.back() == i);
+        dq = dq.pop_back();
+    }
+    CHECK(dq.empty());
+    for (int i = 0; i < 100; ++i)
+        dq = dq.push_front(i);
+    for (int i = 99; i >= 0; --i) {
+        REQUIRE(dq.front() == i);
+        dq = dq.pop_front();
+    }
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Persistent_snapshots_are_unaffected_by_later_versions")
+{
+    std::mt19937 rng(21);
+    PersistentDeque<int> dq;
+    std::deque<int> ref;
+    std::vector<PersistentDeque<int>> snapshots;
+    std::vector<std::deque<int>> expected;
+    for (int step = 0; step < 3000; ++step) {
+        int v = int(rng() % 1000);
+        switch (rng() % 4) {
+            case 0:
+                dq = dq.push_front(v);
+                ref.push_front(v);
+                break;
+            case 1:
+                dq = dq.push_back(v);
+                ref.push_back(v);
+                break;
+            case 2:
+                dq = dq.pop_front();
+                if (!ref.empty())
+                    ref.pop_front();
+                break;
+            default:
+                dq = dq.pop_back();
+                if (!ref.empty())
+                    ref.pop_back();
+                break;
+        }
+        REQUIRE(dq.size() == ref.size());
+        if (!ref.empty()) {
+            REQUIRE(dq.front() == ref.front());
+            REQUIRE(dq.back() == ref.back());
+        }
+        if (step % 300 == 0) {
+            snapshots.push_back(dq);
+            expected.push_back(ref);
+        }
+    }
+    for (size_t i = 0; i < snapshots.size(); ++i)
+        CHECK(contents(snapshots[i]) == expected[i]);
+}
+
+TEST_CASE("Persistent_branches_share_a_prefix")
+{
+    PersistentDeque<int> base;
+    for (int i = 0; i < 5; ++i)
+        base = base.push_back(i);
+    PersistentDeque<int> left = base.push_back(100);
+    PersistentDeque<int> right = base.push_back(200).pop_front();
+    CHECK(contents(base) == std::deque<int>{0, 1, 2, 3, 4});
+    CHECK(contents(left) == std::deque<int>{0, 1, 2, 3, 4, 100});
+    CHECK(contents(right) == std::deque<int>{1, 2, 3, 4, 200});
+}
+
+TEST_CASE("Persistent_releases_long_lists_without_recursion")
+{
+    PersistentDeque<int> dq;
+    for (int i = 0; i < 1000000; ++i)
+        dq = dq.push_front(i);
+    CHECK(dq.size() == 1000000);
+    dq = PersistentDeque<int>();
+    CHECK(dq.empty());
+}
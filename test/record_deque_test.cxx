@@ -0,0 +1,138 @@
+#include "RecordDeque.hxx"
+
+#include <catch.hxx>
+
+#include <deque>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    // Compares as std::string, which Catch can print in any language mode.
+    std::string str(std::string_view r)
+    {
+        return std::string(r);
+    }
+
+    std::vector<std::string> contents(const RecordDeque &dq)
+    {
+        std::vector<std::string> result;
+        dq.for_each([&](std::string_view r) { result.emplace_back(r); });
+        return result;
+    }
+}
+
+TEST_CASE("Record_new_is_empty")
+{
+    RecordDeque dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    dq.pop_front();
+    dq.pop_back();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Record_push_and_pop_both_ends")
+{
+    RecordDeque dq(64);
+    dq.push_back("beta");
+    dq.push_back("");
+    dq.push_front("alpha");
+    dq.push_back("gamma");
+    CHECK(dq.size() == 4);
+    CHECK(str(dq.front()) == "alpha");
+    CHECK(str(dq.back()) == "gamma");
+    CHECK(contents(dq) == std::vector<std::string>{"alpha", "beta", "", "gamma"});
+
+    dq.pop_back();
+    CHECK(str(dq.back()) == "");
+    dq.pop_back();
+    CHECK(str(dq.back()) == "beta");
+    dq.pop_front();
+    CHECK(str(dq.front()) == "beta");
+    dq.pop_front();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Record_binary_bytes")
+{
+    RecordDeque dq;
+    std::string bytes("a\0b\xff", 4);
+    dq.push_back(bytes);
+    CHECK(dq.front().size() == 4);
+    CHECK(str(dq.front()) == bytes);
+}
+
+TEST_CASE("Record_oversized_records")
+{
+    RecordDeque dq(32);
+    std::string big(1000, 'x');
+    dq.push_back("small");
+    dq.push_back(big);
+    dq.push_front(big + "y");
+    dq.push_back("tail");
+    CHECK(contents(dq) == std::vector<std::string>{big + "y", "small", big, "tail"});
+    dq.pop_back();
+    CHECK(str(dq.back()) == big);
+    dq.pop_front();
+    CHECK(str(dq.front()) == "small");
+}
+
+TEST_CASE("Record_random_ops_match_std_deque")
+{
+    std::mt19937 rng(5);
+    RecordDeque dq(48);
+    std::deque<std::string> ref;
+    for (int step = 0; step < 20000; ++step) {
+        std::string s(rng() % 40, char('a' + step % 26));
+        switch (rng() % 4) {
+            case 0:
+                dq.push_back(s);
+                ref.push_back(s);
+                break;
+            case 1:
+                dq.push_front(s);
+                ref.push_front(s);
+                break;
+            case 2:
+                dq.pop_front();
+                if (!ref.empty())
+                    ref.pop_front();
+                break;
+            default:
+                dq.pop_back();
+                if (!ref.empty())
+                    ref.pop_back();
+                break;
+        }
+        REQUIRE(dq.size() == ref.size());
+        if (!ref.empty()) {
+            REQUIRE(str(dq.front()) == ref.front());
+            REQUIRE(str(dq.back()) == ref.back());
+        }
+    }
+    CHECK(contents(dq) == std::vector<std::string>(ref.begin(), ref.end()));
+}
+
+TEST_CASE("Record_move_and_clear")
+{
+    RecordDeque dq(64);
+    for (int i = 0; i < 100; ++i)
+        dq.push_back(std::to_string(i));
+    RecordDeque moved(std::move(dq));
+    CHECK(dq.empty());
+    CHECK(moved.size() == 100);
+    CHECK(str(moved.back()) == "99");
+
+    dq = std::move(moved);
+    CHECK(moved.empty());
+    CHECK(str(dq.front()) == "0");
+    dq.clear();
+    CHECK(dq.empty());
+    dq.push_front("again");
+    CHECK(str(dq.back()) == "again");
+}
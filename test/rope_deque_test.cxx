@@ -0,0 +1,236 @@
+#include "RopeDeque.hxx"
+
+#include <catch.hxx>
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    template<typename T, size_t C>
+    std::vector<T> contents(const RopeDeque<T, C> &dq)
+    {
+        std::vector<T> result;
+        dq.for_each([&](const T &x) { result.push_back(x); });
+        return result;
+    }
+
+    template<size_t C>
+    RopeDeque<int, C> range(int lo, int hi)
+    {
+        RopeDeque<int, C> dq;
+        for (int i = lo; i < hi; ++i)
+            dq.push_back(i);
+        return dq;
+    }
+
+    std::vector<int> iota(int lo, int hi)
+    {
+        std::vector<int> result;
+        for (int i = lo; i < hi; ++i)
+            result.push_back(i);
+        return result;
+    }
+}
+
+TEST_CASE("Rope_new_is_empty")
+{
+    RopeDeque<int> dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    dq.pop_front();
+    dq.pop_back();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Rope_push_and_pop_both_ends")
+{
+    RopeDeque<int, 4> dq;
+    for (int i = 0; i < 20; ++i) {
+        dq.push_back(i);
+        dq.push_front(-i - 1);
+    }
+    CHECK(dq.size() == 40);
+    CHECK(dq.front() == -20);
+    CHECK(dq.back() == 19);
+    for (int i = 0; i < 20; ++i)
+        dq.pop_front();
+    CHECK(contents(dq) == iota(0, 20));
+    for (int i = 19; i >= 0; --i) {
+        REQUIRE(dq.back() == i);
+        dq.pop_back();
+    }
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Rope_drain_from_the_far_end")
+{
+    RopeDeque<int, 4> dq = range<4>(0, 30);
+    for (int i = 0; i < 30; ++i) {
+        REQUIRE(dq.front() == i);
+        dq.pop_front();
+    }
+    CHECK(dq.empty());
+    for (int i = 0; i < 30; ++i)
+        dq.push_front(i);
+    for (int i = 0; i < 30; ++i) {
+        REQUIRE(dq.back() == i);
+        dq.pop_back();
+    }
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Rope_index_every_position")
+{
+    RopeDeque<int, 4> dq = range<4>(0, 100);
+    for (int i = 1; i <= 7; ++i)
+        dq.push_front(-i);
+    for (size_t i = 0; i < dq.size(); ++i)
+        REQUIRE(dq[i] == int(i) - 7);
+    dq[50] = 1000;
+    CHECK(dq[50] == 1000);
+}
+
+TEST_CASE("Rope_concat")
+{
+    RopeDeque<int, 4> a = range<4>(0, 37);
+    RopeDeque<int, 4> b = range<4>(37, 100);
+    b.push_front(36);
+    b.pop_front();
+    a.concat(b);
+    CHECK(b.empty());
+    CHECK(a.size() == 100);
+    CHECK(contents(a) == iota(0, 100));
+    RopeDeque<int, 4> empty;
+    a.concat(empty);
+    CHECK(a.size() == 100);
+    empty.concat(a);
+    CHECK(a.empty());
+    CHECK(contents(empty) == iota(0, 100));
+}
+
+TEST_CASE("Rope_split_at_every_position")
+{
+    for (int i = 0; i <= 50; ++i) {
+        RopeDeque<int, 4> dq = range<4>(0, 50);
+        RopeDeque<int, 4> rest = dq.split_at(size_t(i));
+        REQUIRE(contents(dq) == iota(0, i));
+        REQUIRE(contents(rest) == iota(i, 50));
+        dq.concat(rest);
+        REQUIRE(contents(dq) == iota(0, 50));
+    }
+}
+
+TEST_CASE("Rope_random_slicing_matches_std_deque")
+{
+    std::mt19937 rng(13);
+    RopeDeque<int, 8> dq;
+    std::deque<int> ref;
+    int next = 0;
+    for (int step = 0; step < 3000; ++step) {
+        switch (rng() % 6) {
+            case 0:
+                dq.push_front(next);
+                ref.push_front(next++);
+                break;
+            case 1:
+                dq.push_back(next);
+                ref.push_back(next++);
+                break;
+            case 2:
+                dq.pop_front();
+                if (!ref.empty())
+                    ref.pop_front();
+                break;
+            case 3:
+                dq.pop_back();
+                if (!ref.empty())
+                    ref.pop_back();
+                break;
+            default: {
+                // Cut somewhere, then glue the two halves back in swapped order.
+                size_t cut = ref.empty() ? 0 : rng() % (ref.size() + 1);
+                RopeDeque<int, 8> tail = dq.split_at(cut);
+                tail.concat(dq);
+                dq = std::move(tail);
+                std::rotate(ref.begin(), ref.begin() + long(cut), ref.end());
+                break;
+            }
+        }
+        REQUIRE(dq.size() == ref.size());
+        if (!ref.empty()) {
+            REQUIRE(dq.front() == ref.front());
+            REQUIRE(dq.back() == ref.back());
+            size_t i = rng() % ref.size();
+            REQUIRE(dq[i] == ref[i]);
+        }
+    }
+    CHECK(contents(dq) == std::vector<int>(ref.begin(), ref.end()));
+}
+
+TEST_CASE("Rope_copy_is_deep")
+{
+    RopeDeque<int, 4> dq = range<4>(0, 20);
+    RopeDeque<int, 4> copy(dq);
+    dq[5] = -5;
+    dq.pop_back();
+    CHECK(contents(copy) == iota(0, 20));
+    copy = dq;
+    CHECK(copy.size() == 19);
+    CHECK(copy[5] == -5);
+}
+
+TEST_CASE("Rope_alternate_at_buffer_boundary")
+{
+    // Pushes and pops that straddle a buffer flush or refill, at each end,
+    // with and without a tree in the middle.
+    for (int middle : {0, 100}) {
+        RopeDeque<int, 8> dq = range<8>(0, middle);
+        std::vector<int> init = iota(0, middle);
+        std::deque<int> ref(init.begin(), init.end());
+        for (int i = 1; i <= 7; ++i) {
+            dq.push_front(-i);
+            ref.push_front(-i);
+            dq.push_back(middle + i);
+            ref.push_back(middle + i);
+        }
+        for (int step = 0; step < 100; ++step) {
+            dq.push_front(-1000 - step);
+            ref.push_front(-1000 - step);
+            dq.pop_front();
+            ref.pop_front();
+            dq.pop_back();
+            ref.pop_back();
+            dq.push_back(1000 + step);
+            ref.push_back(1000 + step);
+            REQUIRE(dq.front() == ref.front());
+            REQUIRE(dq.back() == ref.back());
+        }
+        CHECK(contents(dq) == std::vector<int>(ref.begin(), ref.end()));
+    }
+}
+
+TEST_CASE("Rope_small_fifo_without_tree")
+{
+    RopeDeque<int, 64> dq;
+    std::deque<int> ref;
+    for (int i = 0; i < 1000; ++i) {
+        dq.push_back(i);
+        ref.push_back(i);
+        if (i % 3 == 2) {
+            dq.pop_front();
+            ref.pop_front();
+        }
+        REQUIRE(dq.front() == ref.front());
+        REQUIRE(dq.size() == ref.size());
+    }
+    while (!ref.empty()) {
+        REQUIRE(dq.back() == ref.back());
+        dq.pop_back();
+        ref.pop_back();
+    }
+    CHECK(dq.empty());
+}
@@ -0,0 +1,167 @@
+#include "ShardedDeque.hxx"
+
+#include <catch.hxx>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+TEST_CASE("New_is_empty")
+{
+    ShardedDeque<int> dq(4);
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.shard_count() == 4);
+    int x;
+    CHECK_FALSE(dq.try_pop_front(x));
+}
+
+TEST_CASE("Zero_shards_means_one")
+{
+    ShardedDeque<int> dq(0);
+    CHECK(dq.shard_count() == 1);
+}
+
+TEST_CASE("Single_thread_is_fifo")
+{
+    ShardedDeque<int> dq(4);
+    dq.push_back(5);
+    dq.push_back(6);
+    dq.push_back(7);
+    CHECK(dq.size() == 3);
+
+    int x = 0;
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 5);
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 6);
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 7);
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Home_shard_is_stable")
+{
+    ShardedDeque<int> dq(4);
+    CHECK(dq.home_shard() < 4);
+    CHECK(dq.home_shard() == dq.home_shard());
+}
+
+TEST_CASE("Pop_steals_from_other_shards")
+{
+    ShardedDeque<int> dq(4);
+    std::thread other([&] {
+        dq.push_back(5);
+        dq.push_back(6);
+    });
+    other.join();
+    CHECK(dq.size() == 2);
+
+    int x = 0;
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 5);
+    CHECK(dq.try_pop_front(x));
+    CHECK(x == 6);
+    CHECK_FALSE(dq.try_pop_front(x));
+}
+
+TEST_CASE("Fairness_visits_other_shards")
+{
+    ShardedDeque<int> dq(2, 1);
+    dq.push_back(1);
+    dq.push_back(2);
+
+    // Push from new threads until one has the other shard as its home.
+    size_t home = dq.home_shard();
+    bool pushed = false;
+    while (!pushed) {
+        std::thread other([&] {
+            if (dq.home_shard() != home) {
+                dq.push_back(101);
+                dq.push_back(102);
+                pushed = true;
+            }
+        });
+        other.join();
+    }
+
+    // With strict round-robin, four pops alternate between the shards.
+    int local = 0, remote = 0, x;
+    for (int i = 0; i < 2; ++i) {
+        REQUIRE(dq.try_pop_front(x));
+        (x > 100 ? remote : local)++;
+    }
+    CHECK(local == 1);
+    CHECK(remote == 1);
+}
+
+TEST_CASE("Fairness_rotation_is_per_deque")
+{
+    ShardedDeque<int> dq(2, 1);
+    dq.push_back(1);
+    dq.push_back(2);
+    size_t home = dq.home_shard();
+    bool pushed = false;
+    while (!pushed) {
+        std::thread other([&] {
+            if (dq.home_shard() != home) {
+                dq.push_back(101);
+                dq.push_back(102);
+                pushed = true;
+            }
+        });
+        other.join();
+    }
+
+    // Pops from an unrelated deque in between must not shift the rotation.
+    ShardedDeque<int> unrelated(2, 1);
+    int local = 0, remote = 0, x;
+    for (int i = 0; i < 2; ++i) {
+        unrelated.push_back(0);
+        REQUIRE(unrelated.try_pop_front(x));
+        REQUIRE(dq.try_pop_front(x));
+        (x > 100 ? remote : local)++;
+    }
+    CHECK(local == 1);
+    CHECK(remote == 1);
+}
+
+TEST_CASE("Producers_and_consumers_exchange_each_element_once")
+{
+    const int producers = 4, consumers = 4, per_producer = 10000;
+    ShardedDeque<int> dq(4, 8);
+    std::vector<std::atomic<int>> seen(producers * per_producer);
+    for (auto &s : seen)
+        s.store(0);
+
+    std::atomic<int> popped(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&dq, p] {
+            for (int i = 0; i < per_producer; ++i)
+                dq.push_back(p * per_producer + i);
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            int x;
+            while (popped.load() < producers * per_producer) {
+                if (dq.try_pop_front(x)) {
+                    seen[x].fetch_add(1);
+                    popped.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    int wrong = 0;
+    for (auto &s : seen)
+        if (s.load() != 1)
+            ++wrong;
+    CHECK(wrong == 0);
+    CHECK(dq.empty());
+}
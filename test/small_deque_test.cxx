@@ -0,0 +1,132 @@
+#include "SmallDeque.hxx"
+
+#include <catch.hxx>
+
+#include <string>
+
+using namespace ipd;
+
+TEST_CASE("New_is_empty_and_inline")
+{
+    SmallDeque<int, 4> dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.is_inline());
+}
+
+TEST_CASE("Stays_inline_up_to_K")
+{
+    SmallDeque<int, 4> dq{1, 2, 3, 4};
+    CHECK(dq.is_inline());
+    CHECK(dq.size() == 4);
+    CHECK(dq.front() == 1);
+    CHECK(dq.back() == 4);
+}
+
+TEST_CASE("Spills_past_K_preserving_order")
+{
+    SmallDeque<int, 4> dq;
+    dq.push_back(3);
+    dq.push_back(4);
+    dq.push_front(2);
+    dq.push_front(1);
+    CHECK(dq.is_inline());
+    dq.push_back(5);
+    CHECK_FALSE(dq.is_inline());
+    dq.push_front(0);
+    CHECK(dq.size() == 6);
+
+    for (int i = 0; i <= 5; ++i) {
+        CHECK(dq.front() == i);
+        dq.pop_front();
+    }
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Spill_at_front")
+{
+    SmallDeque<int, 2> dq{1, 2};
+    dq.push_front(0);
+    CHECK_FALSE(dq.is_inline());
+    CHECK(dq.front() == 0);
+    CHECK(dq.back() == 2);
+}
+
+TEST_CASE("Returns_inline_when_emptied")
+{
+    SmallDeque<int, 2> dq{1, 2, 3};
+    CHECK_FALSE(dq.is_inline());
+    dq.pop_back();
+    dq.pop_back();
+    dq.pop_back();
+    CHECK(dq.empty());
+    CHECK(dq.is_inline());
+    dq.push_back(7);
+    CHECK(dq.is_inline());
+    CHECK(dq.front() == 7);
+}
+
+TEST_CASE("Clear_returns_inline")
+{
+    SmallDeque<int, 2> dq{1, 2, 3};
+    dq.clear();
+    CHECK(dq.empty());
+    CHECK(dq.is_inline());
+}
+
+TEST_CASE("Copy_inline_and_spilled")
+{
+    SmallDeque<std::string, 2> small{"a"};
+    SmallDeque<std::string, 2> big{"a", "b", "c"};
+
+    SmallDeque<std::string, 2> small2(small);
+    SmallDeque<std::string, 2> big2(big);
+    CHECK(small2.is_inline());
+    CHECK_FALSE(big2.is_inline());
+    big2.push_back("d");
+    CHECK(big.size() == 3);
+    CHECK(big2.size() == 4);
+    CHECK(big2.front() == "a");
+}
+
+TEST_CASE("Assign_across_states")
+{
+    SmallDeque<std::string, 2> small{"x"};
+    SmallDeque<std::string, 2> big{"a", "b", "c"};
+
+    small = big;
+    CHECK_FALSE(small.is_inline());
+    CHECK(small.size() == 3);
+
+    SmallDeque<std::string, 2> other{"y"};
+    big = other;
+    CHECK(big.is_inline());
+    CHECK(big.front() == "y");
+}
+
+TEST_CASE("Move_inline")
+{
+    SmallDeque<std::string, 4> dq1{"a", "b"};
+    SmallDeque<std::string, 4> dq2(std::move(dq1));
+    CHECK(dq1.empty());
+    CHECK(dq1.is_inline());
+    CHECK(dq2.is_inline());
+    CHECK(dq2.back() == "b");
+}
+
+TEST_CASE("Move_spilled_steals_heap")
+{
+    SmallDeque<std::string, 2> dq1{"a", "b", "c"};
+    const std::string *first = &dq1.front();
+    SmallDeque<std::string, 2> dq2(std::move(dq1));
+    CHECK(dq1.empty());
+    CHECK(dq1.is_inline());
+    CHECK_FALSE(dq2.is_inline());
+    CHECK(&dq2.front() == first);
+
+    SmallDeque<std::string, 2> dq3{"z"};
+    dq3 = std::move(dq2);
+    CHECK(dq2.empty());
+    CHECK(&dq3.front() == first);
+    CHECK(dq3.size() == 3);
+}
@@ -0,0 +1,232 @@
+#include "SpillDeque.hxx"
+
+#include <catch.hxx>
+
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <string>
+#include <system_error>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace ipd;
+
+namespace {
+    // Blocks of 8 ints, at most 3 of them in memory.
+    const size_t block_bytes = 8 * sizeof(int);
+    const size_t budget = 3 * block_bytes;
+
+#ifdef __linux__
+    // Returns the descriptor of this process's spill file, or -1.
+    int spill_fd()
+    {
+        int found = -1;
+        DIR *dir = ::opendir("/proc/self/fd");
+        if (!dir)
+            return found;
+        while (dirent *entry = ::readdir(dir)) {
+            char target[4096];
+            std::string path = std::string("/proc/self/fd/") + entry->d_name;
+            ssize_t n = ::readlink(path.c_str(), target, sizeof target - 1);
+            if (n > 0 && std::string(target, size_t(n)).find("ipd-spill-") != std::string::npos)
+                found = std::atoi(entry->d_name);
+        }
+        ::closedir(dir);
+        return found;
+    }
+#endif
+}
+
+TEST_CASE("Spill_new_is_empty")
+{
+    SpillDeque<int> dq(budget, block_bytes);
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.resident_blocks() == 0);
+    CHECK(dq.spilled_blocks() == 0);
+    dq.pop_front();
+    dq.pop_back();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Spill_small_deque_stays_in_memory")
+{
+    SpillDeque<int> dq(budget, block_bytes);
+    for (int i = 0; i < 24; ++i)
+        dq.push_back(i);
+    CHECK(dq.resident_blocks() == 3);
+    CHECK(dq.spilled_blocks() == 0);
+    CHECK(dq.front() == 0);
+    CHECK(dq.back() == 23);
+}
+
+TEST_CASE("Spill_fifo_through_disk")
+{
+    const int n = 10000;
+    SpillDeque<int> dq(budget, block_bytes);
+    for (int i = 0; i < n; ++i) {
+        dq.push_back(i);
+        REQUIRE(dq.resident_blocks() <= 3);
+    }
+    CHECK(dq.spilled_blocks() > 1000);
+    for (int i = 0; i < n; ++i) {
+        REQUIRE(dq.front() == i);
+        REQUIRE(dq.back() == n - 1);
+        dq.pop_front();
+        REQUIRE(dq.resident_blocks() <= 3);
+    }
+    CHECK(dq.empty());
+    CHECK(dq.spilled_blocks() == 0);
+}
+
+TEST_CASE("Spill_lifo_from_both_ends")
+{
+    const int n = 5000;
+    SpillDeque<int> dq(budget, block_bytes);
+    for (int i = 0; i < n; ++i)
+        dq.push_front(i);
+    CHECK(dq.spilled_blocks() > 0);
+    for (int i = 0; i < n; ++i) {
+        REQUIRE(dq.back() == i);
+        dq.pop_back();
+    }
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Spill_random_ops_match_std_deque")
+{
+    std::mt19937 rng(21);
+    SpillDeque<int64_t> dq(4 * 16 * sizeof(int64_t), 16 * sizeof(int64_t));
+    std::deque<int64_t> ref;
+    int64_t next = 0;
+    for (int step = 0; step < 50000; ++step) {
+        // Grow on average, so that the middle spills.
+        switch (rng() % 5) {
+            case 0:
+            case 1:
+                dq.push_back(next);
+                ref.push_back(next++);
+                break;
+            case 2:
+                dq.push_front(next);
+                ref.push_front(next++);
+                break;
+            case 3:
+                dq.pop_front();
+                if (!ref.empty())
+                    ref.pop_front();
+                break;
+            default:
+                dq.pop_back();
+                if (!ref.empty())
+                    ref.pop_back();
+                break;
+        }
+        REQUIRE(dq.size() == ref.size());
+        REQUIRE(dq.resident_blocks() <= 4);
+        if (!ref.empty()) {
+            REQUIRE(dq.front() == ref.front());
+            REQUIRE(dq.back() == ref.back());
+        }
+    }
+    CHECK(dq.spilled_blocks() > 0);
+    while (!ref.empty()) {
+        REQUIRE(dq.front() == ref.front());
+        dq.pop_front();
+        ref.pop_front();
+    }
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Spill_clear_and_reuse")
+{
+    SpillDeque<int> dq(budget, block_bytes);
+    for (int i = 0; i < 1000; ++i)
+        dq.push_back(i);
+    dq.clear();
+    CHECK(dq.empty());
+    CHECK(dq.spilled_blocks() == 0);
+    for (int i = 0; i < 1000; ++i)
+        dq.push_back(-i);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(dq.front() == -i);
+        dq.pop_front();
+    }
+}
+
+TEST_CASE("Spill_failed_push_leaves_deque_unchanged")
+{
+    // Room for two blocks, and nowhere to spill a third.
+    SpillDeque<int> dq(2 * block_bytes, block_bytes, "/nonexistent-dir");
+    for (int i = 0; i < 16; ++i)
+        dq.push_back(i);
+    CHECK_THROWS_AS(dq.push_back(16), std::system_error);
+    CHECK_THROWS_AS(dq.push_front(-1), std::system_error);
+    CHECK(dq.size() == 16);
+    CHECK(dq.resident_blocks() == 2);
+    CHECK(dq.spilled_blocks() == 0);
+    CHECK(dq.front() == 0);
+    CHECK(dq.back() == 15);
+    for (int i = 15; i >= 8; --i) {
+        REQUIRE(dq.back() == i);
+        dq.pop_back();
+    }
+    for (int i = 0; i < 8; ++i) {
+        REQUIRE(dq.front() == i);
+        dq.pop_front();
+    }
+    CHECK(dq.empty());
+}
+
+#ifdef __linux__
+TEST_CASE("Spill_failed_read_keeps_order")
+{
+    SpillDeque<int> dq(budget, block_bytes);
+    for (int i = 0; i < 64; ++i)
+        dq.push_back(i);
+    REQUIRE(dq.spilled_blocks() > 0);
+
+    // Swap a write-only descriptor in under the spill file, so every pread
+    // fails with EBADF, then put the file back.
+    int fd = spill_fd();
+    REQUIRE(fd >= 0);
+    int saved = ::dup(fd);
+    int broken = ::open("/dev/null", O_WRONLY);
+    REQUIRE(saved >= 0);
+    REQUIRE(broken >= 0);
+    REQUIRE(::dup2(broken, fd) == fd);
+
+    int next = 0;
+    bool threw = false;
+    while (!threw) {
+        try {
+            dq.pop_front();
+            ++next;
+        } catch (const std::system_error &) {
+            threw = true;
+        }
+    }
+    CHECK(next < 64);
+    CHECK(dq.size() == size_t(64 - next));
+    CHECK(dq.front() == next);
+    CHECK(dq.back() == 63);
+    CHECK_THROWS_AS(dq.pop_front(), std::system_error);
+    CHECK(dq.front() == next);
+
+    REQUIRE(::dup2(saved, fd) == fd);
+    ::close(saved);
+    ::close(broken);
+    while (!dq.empty()) {
+        REQUIRE(dq.front() == next);
+        dq.pop_front();
+        ++next;
+    }
+    CHECK(next == 64);
+}
+#endif
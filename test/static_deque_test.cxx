@@ -0,0 +1,177 @@
+#include "StaticDeque.hxx"
+
+#include <catch.hxx>
+
+#include <string>
+
+using namespace ipd;
+
+namespace {
+    // Counts live instances, to check that the deque constructs and
+    // destroys elements exactly once.
+    struct Tracked {
+        static int live;
+        int value;
+
+        Tracked(int v) : value(v) { ++live; }
+        Tracked(const Tracked &other) : value(other.value) { ++live; }
+        ~Tracked() { --live; }
+    };
+
+    int Tracked::live = 0;
+}
+
+TEST_CASE("New_is_empty")
+{
+    StaticDeque<int, 4> dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.capacity() == 4);
+    CHECK_FALSE(dq.full());
+}
+
+TEST_CASE("Initializer_list")
+{
+    StaticDeque<int, 4> dq{5, 6, 7};
+    CHECK(dq.size() == 3);
+    CHECK(dq.front() == 5);
+    CHECK(dq.back() == 7);
+}
+
+TEST_CASE("Fronts_and_backs_then_fronts")
+{
+    StaticDeque<int, 10> dq;
+    dq.push_front(5);
+    dq.push_back(6);
+    dq.push_front(4);
+    dq.push_back(7);
+    dq.push_front(3);
+    dq.push_back(8);
+    dq.push_front(2);
+    dq.push_back(9);
+    dq.push_front(1);
+    dq.push_back(10);
+    CHECK(dq.full());
+    for (int i = 1; i <= 10; ++i) {
+        CHECK(dq.front() == i);
+        dq.pop_front();
+    }
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Fronts_and_backs_then_backs")
+{
+    StaticDeque<int, 16> dq;
+    dq.push_front(5);
+    dq.push_back(6);
+    dq.push_front(4);
+    dq.push_back(7);
+    dq.push_front(3);
+    dq.push_back(8);
+    for (int i = 8; i >= 3; --i) {
+        CHECK(dq.back() == i);
+        dq.pop_back();
+    }
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Try_push_reports_overflow")
+{
+    StaticDeque<int, 2> dq;
+    CHECK(dq.try_push_back(5));
+    CHECK(dq.try_push_front(4));
+    CHECK(dq.full());
+    CHECK_FALSE(dq.try_push_back(6));
+    CHECK_FALSE(dq.try_push_front(3));
+    CHECK(dq.front() == 4);
+    CHECK(dq.back() == 5);
+}
+
+TEST_CASE("Wraps_around_repeatedly")
+{
+    StaticDeque<int, 3> odd;
+    StaticDeque<int, 4> pow2;
+    for (int i = 0; i < 100; ++i) {
+        odd.push_back(i);
+        pow2.push_back(i);
+        if (odd.size() == 3) {
+            CHECK(odd.front() == i - 2);
+            odd.pop_front();
+        }
+        if (pow2.size() == 4) {
+            CHECK(pow2.front() == i - 3);
+            pow2.pop_front();
+        }
+    }
+    CHECK(odd.back() == 99);
+    CHECK(pow2.back() == 99);
+}
+
+TEST_CASE("Pop_on_empty_does_nothing")
+{
+    StaticDeque<int, 2> dq;
+    dq.pop_front();
+    dq.pop_back();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Copy")
+{
+    StaticDeque<std::string, 4> dq1{"a", "b"};
+    StaticDeque<std::string, 4> dq2(dq1);
+    dq2.push_back("c");
+    CHECK(dq2.size() == 3);
+    CHECK(dq1.size() == 2);
+    CHECK(dq1.back() == "b");
+}
+
+TEST_CASE("Assign")
+{
+    StaticDeque<std::string, 4> dq1{"a", "b"};
+    StaticDeque<std::string, 4> dq2{"x"};
+    dq2 = dq1;
+    CHECK(dq2.front() == "a");
+    CHECK(dq2.back() == "b");
+}
+
+TEST_CASE("Move_leaves_source_empty")
+{
+    StaticDeque<std::string, 4> dq1{"a", "b"};
+    StaticDeque<std::string, 4> dq2(std::move(dq1));
+    CHECK(dq1.empty());
+    CHECK(dq2.size() == 2);
+
+    StaticDeque<std::string, 4> dq3;
+    dq3 = std::move(dq2);
+    CHECK(dq2.empty());
+    CHECK(dq3.front() == "a");
+}
+
+TEST_CASE("Splice")
+{
+    StaticDeque<int, 5> dq1{10, 11};
+    StaticDeque<int, 5> dq2{18, 12, 13};
+    dq1.splice(dq2);
+    CHECK(dq1.size() == 5);
+    CHECK(dq2.empty());
+    CHECK(dq1.front() == 10);
+    CHECK(dq1.back() == 13);
+}
+
+TEST_CASE("Elements_are_destroyed")
+{
+    Tracked::live = 0;
+    {
+        StaticDeque<Tracked, 4> dq;
+        dq.push_back(Tracked(1));
+        dq.push_front(Tracked(0));
+        dq.push_back(Tracked(2));
+        CHECK(Tracked::live == 3);
+        dq.pop_front();
+        CHECK(Tracked::live == 2);
+        dq.pop_back();
+        CHECK(Tracked::live == 1);
+        dq.push_back(Tracked(3));
+    }
+    CHECK(Tracked::live == 0);
+}
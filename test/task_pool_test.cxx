@@ -0,0 +1,107 @@
+#include "TaskPool.hxx"
+
+#include <catch.hxx>
+
+#include <atomic>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    long fib(TaskPool &pool, int n)
+    {
+        if (n < 12) {
+            return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+        }
+        long results[2];
+        pool.parallel_for(0, 2, [&](size_t i) {
+            results[i] = fib(pool, n - 1 - int(i));
+        });
+        return results[0] + results[1];
+    }
+}
+
+TEST_CASE("Size_is_number_of_threads")
+{
+    TaskPool pool(3);
+    CHECK(pool.size() == 3);
+}
+
+TEST_CASE("Zero_threads_means_one")
+{
+    TaskPool pool(0);
+    CHECK(pool.size() == 1);
+}
+
+TEST_CASE("Submit_runs_every_task")
+{
+    TaskPool pool(4);
+    std::atomic<int> count(0);
+    for (int i = 0; i < 1000; ++i)
+        pool.submit([&] { count.fetch_add(1); });
+    pool.wait_idle();
+    CHECK(count.load() == 1000);
+}
+
+TEST_CASE("Tasks_can_submit_tasks")
+{
+    TaskPool pool(4);
+    std::atomic<int> count(0);
+    for (int i = 0; i < 10; ++i) {
+        pool.submit([&] {
+            for (int j = 0; j < 100; ++j)
+                pool.submit([&] { count.fetch_add(1); });
+        });
+    }
+    pool.wait_idle();
+    CHECK(count.load() == 1000);
+}
+
+TEST_CASE("Wait_idle_with_nothing_submitted")
+{
+    TaskPool pool(2);
+    pool.wait_idle();
+    CHECK(pool.size() == 2);
+}
+
+TEST_CASE("Parallel_for_visits_each_index_once")
+{
+    TaskPool pool(4);
+    std::vector<std::atomic<int>> hits(10000);
+    for (auto &h : hits)
+        h.store(0);
+
+    pool.parallel_for(0, hits.size(), [&](size_t i) { hits[i].fetch_add(1); },
+                      16);
+
+    int wrong = 0;
+    for (auto &h : hits)
+        if (h.load() != 1)
+            ++wrong;
+    CHECK(wrong == 0);
+}
+
+TEST_CASE("Parallel_for_empty_range")
+{
+    TaskPool pool(2);
+    int calls = 0;
+    pool.parallel_for(5, 5, [&](size_t) { ++calls; });
+    CHECK(calls == 0);
+}
+
+TEST_CASE("Nested_parallel_for")
+{
+    TaskPool pool(4);
+    CHECK(fib(pool, 22) == 17711);
+}
+
+TEST_CASE("Destructor_finishes_pending_tasks")
+{
+    std::atomic<int> count(0);
+    {
+        TaskPool pool(2);
+        for (int i = 0; i < 100; ++i)
+            pool.submit([&] { count.fetch_add(1); });
+    }
+    CHECK(count.load() == 100);
+}
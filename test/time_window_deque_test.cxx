@@ -0,0 +1,139 @@
+#include "TimeWindowDeque.hxx"
+
+#include <catch.hxx>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+using namespace ipd;
+
+namespace {
+    // A clock that only moves when the test says so.
+    struct ManualClock {
+        using rep = long;
+        using period = std::milli;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<ManualClock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now() { return current; }
+
+        static time_point current;
+    };
+
+    ManualClock::time_point ManualClock::current;
+
+    ManualClock::time_point at(long ms)
+    {
+        return ManualClock::time_point(ManualClock::duration(ms));
+    }
+}
+
+TEST_CASE("TimeWindow_new_is_empty")
+{
+    TimeWindowDeque<int, ManualClock> dq(ManualClock::duration(100));
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.count_in_window(at(0)) == 0);
+    CHECK(dq.expire(at(1000)) == 0);
+    dq.pop_front();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("TimeWindow_expire_in_batches")
+{
+    TimeWindowDeque<int, ManualClock> dq(ManualClock::duration(1000));
+    for (int i = 0; i < 50; ++i)
+        dq.push_back(i, at(10 * i));
+    CHECK(dq.size() == 50);
+    CHECK(dq.front_time() == at(0));
+    CHECK(dq.back_time() == at(490));
+
+    // At 1390 the window is [390, 1390].
+    CHECK(dq.count_in_window(at(1390)) == 11);
+    CHECK(dq.size() == 50);
+    CHECK(dq.expire(at(1390)) == 39);
+    CHECK(dq.size() == 11);
+    CHECK(dq.front() == 39);
+    CHECK(dq.back() == 49);
+
+    CHECK(dq.expire(at(5000)) == 11);
+    CHECK(dq.empty());
+}
+
+TEST_CASE("TimeWindow_push_evicts_lazily")
+{
+    TimeWindowDeque<int, ManualClock> dq(ManualClock::duration(100));
+    dq.push_back(1, at(0));
+    dq.push_back(2, at(50));
+    dq.push_back(3, at(100));
+    CHECK(dq.size() == 3);
+    dq.push_back(4, at(101));
+    CHECK(dq.size() == 3);
+    CHECK(dq.front() == 2);
+    dq.push_back(5, at(500));
+    CHECK(dq.size() == 1);
+    CHECK(dq.front() == 5);
+}
+
+TEST_CASE("TimeWindow_uses_the_clock")
+{
+    TimeWindowDeque<int, ManualClock> dq(ManualClock::duration(10));
+    ManualClock::current = at(0);
+    dq.push_back(1);
+    ManualClock::current = at(5);
+    dq.push_back(2);
+    CHECK(dq.count_in_window() == 2);
+    ManualClock::current = at(12);
+    CHECK(dq.count_in_window() == 1);
+    CHECK(dq.size() == 2);
+    CHECK(dq.expire() == 1);
+    CHECK(dq.front() == 2);
+    CHECK(dq.front_time() == at(5));
+}
+
+TEST_CASE("TimeWindow_stamps_never_decrease")
+{
+    TimeWindowDeque<int, ManualClock> dq(ManualClock::duration(100));
+    dq.push_back(1, at(200));
+    dq.push_back(2, at(150));
+    CHECK(dq.back_time() == at(200));
+    CHECK(dq.expire(at(300)) == 0);
+    CHECK(dq.expire(at(301)) == 2);
+}
+
+TEST_CASE("TimeWindow_wraps_and_grows")
+{
+    TimeWindowDeque<std::string, ManualClock> dq(ManualClock::duration(20));
+    for (int i = 0; i < 1000; ++i) {
+        dq.push_back(std::to_string(i), at(i));
+        REQUIRE(dq.size() == size_t(i < 20 ? i + 1 : 21));
+        REQUIRE(dq.front() == std::to_string(i < 20 ? 0 : i - 20));
+        REQUIRE(dq.back() == std::to_string(i));
+    }
+    for (int i = 0; i < 21; ++i)
+        dq.pop_front();
+    CHECK(dq.empty());
+    for (int i = 0; i < 100; ++i)
+        dq.push_back(std::to_string(i), at(2000));
+    CHECK(dq.count_in_window(at(2020)) == 100);
+    CHECK(dq.front() == "0");
+}
+
+TEST_CASE("TimeWindow_destroys_elements")
+{
+    auto counter = std::make_shared<int>(0);
+    {
+        TimeWindowDeque<std::shared_ptr<int>, ManualClock> dq(ManualClock::duration(5));
+        for (int i = 0; i < 30; ++i)
+            dq.push_back(counter, at(i));
+        CHECK(counter.use_count() == 7);
+        dq.expire(at(100));
+        CHECK(counter.use_count() == 1);
+        for (int i = 0; i < 3; ++i)
+            dq.push_back(counter, at(100));
+        CHECK(counter.use_count() == 4);
+    }
+    CHECK(counter.use_count() == 1);
+}
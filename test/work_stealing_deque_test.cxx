@@ -0,0 +1,108 @@
+#include "WorkStealingDeque.hxx"
+
+#include <catch.hxx>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace ipd;
+
+TEST_CASE("New_is_empty")
+{
+    WorkStealingDeque<int> dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+}
+
+TEST_CASE("Pop_back_is_lifo")
+{
+    WorkStealingDeque<int> dq;
+    dq.push_back(5);
+    dq.push_back(6);
+    dq.push_back(7);
+    CHECK(dq.size() == 3);
+
+    int x = 0;
+    CHECK(dq.try_pop_back(x));
+    CHECK(x == 7);
+    CHECK(dq.try_pop_back(x));
+    CHECK(x == 6);
+    CHECK(dq.try_pop_back(x));
+    CHECK(x == 5);
+    CHECK_FALSE(dq.try_pop_back(x));
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Steal_front_is_fifo")
+{
+    WorkStealingDeque<int> dq;
+    dq.push_back(5);
+    dq.push_back(6);
+    dq.push_back(7);
+
+    int x = 0;
+    CHECK(dq.try_steal_front(x));
+    CHECK(x == 5);
+    CHECK(dq.try_pop_back(x));
+    CHECK(x == 7);
+    CHECK(dq.try_steal_front(x));
+    CHECK(x == 6);
+    CHECK_FALSE(dq.try_steal_front(x));
+}
+
+TEST_CASE("Grows_past_initial_capacity")
+{
+    WorkStealingDeque<int> dq(2);
+    for (int i = 0; i < 1000; ++i)
+        dq.push_back(i);
+    CHECK(dq.size() == 1000);
+
+    int x = 0;
+    CHECK(dq.try_steal_front(x));
+    CHECK(x == 0);
+    for (int i = 999; i >= 1; --i) {
+        CHECK(dq.try_pop_back(x));
+        CHECK(x == i);
+    }
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Concurrent_steals_take_each_element_once")
+{
+    const int n = 20000;
+    WorkStealingDeque<int> dq(4);
+    std::vector<std::atomic<int>> seen(n);
+    for (auto &s : seen)
+        s.store(0);
+
+    std::atomic<bool> done(false);
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&] {
+            int x;
+            while (!done.load() || !dq.empty()) {
+                if (dq.try_steal_front(x))
+                    seen[x].fetch_add(1);
+            }
+        });
+    }
+
+    int x;
+    for (int i = 0; i < n; ++i) {
+        dq.push_back(i);
+        if (i % 3 == 0 && dq.try_pop_back(x))
+            seen[x].fetch_add(1);
+    }
+    while (dq.try_pop_back(x))
+        seen[x].fetch_add(1);
+    done.store(true);
+    for (auto &t : thieves)
+        t.join();
+
+    int wrong = 0;
+    for (auto &s : seen)
+        if (s.load() != 1)
+            ++wrong;
+    CHECK(wrong == 0);
+}
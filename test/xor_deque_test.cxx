@@ -0,0 +1,112 @@
+#include "XorDeque.hxx"
+
+#include <catch.hxx>
+
+#include <string>
+#include <vector>
+
+using namespace ipd;
+
+namespace {
+    template<typename T>
+    std::vector<T> contents(const XorDeque<T> &dq)
+    {
+        return std::vector<T>(dq.begin(), dq.end());
+    }
+}
+
+TEST_CASE("Xor_new_is_empty")
+{
+    XorDeque<int> dq;
+    CHECK(dq.empty());
+    CHECK(dq.size() == 0);
+    CHECK(dq.begin() == dq.end());
+}
+
+TEST_CASE("Xor_push_both_ends")
+{
+    XorDeque<int> dq;
+    dq.push_back(2);
+    dq.push_front(1);
+    dq.push_back(3);
+    CHECK(dq.size() == 3);
+    CHECK(dq.front() == 1);
+    CHECK(dq.back() == 3);
+    CHECK(contents(dq) == std::vector<int>{1, 2, 3});
+}
+
+TEST_CASE("Xor_pop_both_ends")
+{
+    XorDeque<int> dq{1, 2, 3, 4};
+    dq.pop_front();
+    CHECK(dq.front() == 2);
+    dq.pop_back();
+    CHECK(dq.back() == 3);
+    dq.pop_back();
+    dq.pop_back();
+    CHECK(dq.empty());
+    dq.pop_front();
+    CHECK(dq.empty());
+}
+
+TEST_CASE("Xor_iterate_backwards")
+{
+    XorDeque<int> dq{1, 2, 3};
+    std::vector<int> seen;
+    for (auto it = dq.end(); it != dq.begin();)
+        seen.push_back(*--it);
+    CHECK(seen == std::vector<int>{3, 2, 1});
+}
+
+TEST_CASE("Xor_many_elements_reuse_nodes")
+{
+    XorDeque<int> dq;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 5000; ++i) {
+            if (i % 2)
+                dq.push_back(i);
+            else
+                dq.push_front(i);
+        }
+        CHECK(dq.size() == 5000);
+        CHECK(dq.front() == 4998);
+        CHECK(dq.back() == 4999);
+        for (int i = 0; i < 2500; ++i) {
+            dq.pop_front();
+            dq.pop_back();
+        }
+        CHECK(dq.empty());
+    }
+}
+
+TEST_CASE("Xor_copy_and_assign")
+{
+    XorDeque<std::string> dq{"a", "b", "c"};
+    XorDeque<std::string> copy(dq);
+    dq.pop_front();
+    CHECK(contents(copy) == std::vector<std::string>{"a", "b", "c"});
+    copy = dq;
+    CHECK(contents(copy) == std::vector<std::string>{"b", "c"});
+    XorDeque<std::string> &alias = copy;
+    copy = alias;
+    CHECK(copy.size() == 2);
+}
+
+TEST_CASE("Xor_clear_destroys_elements")
+{
+    XorDeque<std::string> dq{"long enough to allocate on the heap, surely"};
+    dq.push_front("another string that does not fit in SSO");
+    dq.clear();
+    CHECK(dq.empty());
+    dq.push_back("x");
+    CHECK(dq.front() == "x");
+}
+
+TEST_CASE("Xor_splice")
+{
+    XorDeque<int> dq1{1, 2};
+    XorDeque<int> dq2{3, 4, 5};
+    dq1.splice(dq2);
+    CHECK(dq2.empty());
+    CHECK(contents(dq1) == std::vector<int>{1, 2, 3, 4, 5});
+}